@@ -27,6 +27,8 @@ import org.apache.log4j.Logger;
 
 import java.io.IOException;
 import java.io.OutputStream;
+import java.nio.ByteBuffer;
+import java.nio.channels.SocketChannel;
 
 /*******************************************************
  * The actual sender for sending the data.
@@ -126,6 +128,11 @@ public class DataSender extends Sender {
   protected void sendDataBytes(Connection conn,
     final ByteArray opArray, final Data data)
     throws IOException {
+    SocketChannel channel = conn.getChannel();
+    if (channel != null) {
+      sendDataBuffers(channel, opArray, data);
+      return;
+    }
     // Get op bytes and size
     OutputStream out = conn.getOutputStream();
     byte[] opBytes = opArray.get();
@@ -150,6 +157,51 @@ public class DataSender extends Sender {
     }
   }
 
+  /**
+   * Send the command, the op bytes, the head
+   * bytes and the body bytes with one gathering
+   * write.
+   * 
+   * @param channel
+   *          the SocketChannel
+   * @param opArray
+   *          the ByteArray storing the size of
+   *          the head array
+   * @param data
+   *          the Data to be sent
+   * @throws IOException
+   */
+  private void sendDataBuffers(
+    final SocketChannel channel,
+    final ByteArray opArray, final Data data)
+    throws IOException {
+    ByteArray headArray = data.getHeadArray();
+    ByteBuffer[] buffers = new ByteBuffer[4];
+    buffers[0] = ByteBuffer
+      .wrap(new byte[] { getCommand() });
+    buffers[1] = ByteBuffer.wrap(opArray.get(), 0,
+      opArray.size());
+    buffers[2] = ByteBuffer.wrap(headArray.get(),
+      0, headArray.size());
+    // Sending or receiving null array is allowed
+    DataStatus bodyStatus = data.getBodyStatus();
+    if (bodyStatus == DataStatus.ENCODED_ARRAY_DECODED
+      || bodyStatus == DataStatus.ENCODED_ARRAY
+      || bodyStatus == DataStatus.ENCODED_ARRAY_DECODE_FAILED) {
+      ByteArray bodyArray = data.getBodyArray();
+      buffers[3] = ByteBuffer.wrap(bodyArray.get(),
+        bodyArray.start(), bodyArray.size());
+    } else {
+      buffers[3] = ByteBuffer.allocate(0);
+    }
+    while (buffers[3].hasRemaining()
+      || buffers[2].hasRemaining()
+      || buffers[1].hasRemaining()
+      || buffers[0].hasRemaining()) {
+      channel.write(buffers);
+    }
+  }
+
   /**
    * Send the data body
    * 
@@ -20,6 +20,7 @@ import edu.iu.harp.io.Connection;
 import edu.iu.harp.io.Constant;
 import edu.iu.harp.io.Data;
 import edu.iu.harp.io.DataStatus;
+import edu.iu.harp.trace.Tracer;
 import edu.iu.harp.worker.WorkerInfo;
 import edu.iu.harp.worker.Workers;
 import org.apache.log4j.Logger;
@@ -118,6 +119,7 @@ public abstract class Sender {
         .getBodyStatus() == DataStatus.DECODE_FAILED) {
       return false;
     }
+    long startTime = Tracer.now();
     if (data
       .getHeadStatus() == DataStatus.DECODED) {
       DataStatus headStatus = data.encodeHead();
@@ -134,11 +136,14 @@ public abstract class Sender {
         return false;
       }
     }
+    long encodedTime = Tracer.now();
     // Open connection
     Connection conn =
       Connection.create(host, port, true);
     if (conn == null) {
       // Do not release encoded arrays in data.
+      Tracer.get().recordSend(data, startTime,
+        encodedTime, Tracer.now(), false);
       return false;
     }
     // Send
@@ -151,6 +156,8 @@ public abstract class Sender {
       conn.free();
       isFailed = true;
     }
+    Tracer.get().recordSend(data, startTime,
+      encodedTime, Tracer.now(), !isFailed);
     // Do not release encoded arrays in data
     return !isFailed;
   }
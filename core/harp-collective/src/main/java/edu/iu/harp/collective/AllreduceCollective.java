@@ -28,15 +28,20 @@ import edu.iu.harp.io.EventQueue;
 import edu.iu.harp.io.IOUtil;
 import edu.iu.harp.partition.Partition;
 import edu.iu.harp.partition.PartitionUtil;
+import edu.iu.harp.partition.Partitioner;
 import edu.iu.harp.partition.Table;
 import edu.iu.harp.resource.DoubleArray;
 import edu.iu.harp.resource.Simple;
 import edu.iu.harp.resource.Transferable;
 import edu.iu.harp.server.Server;
 import edu.iu.harp.worker.Workers;
+import it.unimi.dsi.fastutil.ints.Int2IntOpenHashMap;
 import it.unimi.dsi.fastutil.ints.Int2ObjectOpenHashMap;
+import it.unimi.dsi.fastutil.ints.IntArrayList;
+import it.unimi.dsi.fastutil.ints.IntOpenHashSet;
 import org.apache.log4j.Logger;
 
+import java.util.Iterator;
 import java.util.LinkedList;
 import java.util.List;
 import java.util.concurrent.ForkJoinPool;
@@ -59,20 +64,30 @@ public class AllreduceCollective {
     int partitionByteSize =
       Integer.parseInt(args[4]);
     int numPartitions = Integer.parseInt(args[5]);
+    AllreduceMode mode = AllreduceMode.AUTO;
+    if (args.length > 6) {
+      mode = AllreduceMode.valueOf(args[6]);
+    }
+    // Use NIO transport if the optional argument
+    // is "nio"
+    boolean useNIO =
+      args.length > 7 && args[7].equals("nio");
     Driver.initLogger(workerID);
     LOG.info("args[] " + driverHost + " "
       + driverPort + " " + workerID + " " + jobID
       + " " + partitionByteSize + " "
-      + numPartitions);
+      + numPartitions + " " + mode + " "
+      + useNIO);
     // ------------------------------------------------
     // Worker initialize
     EventQueue eventQueue = new EventQueue();
     DataMap dataMap = new DataMap();
     Workers workers = new Workers(workerID);
+    ConnPool.get().setUseNIO(useNIO);
     Server server =
       new Server(workers.getSelfInfo().getNode(),
         workers.getSelfInfo().getPort(),
-        eventQueue, dataMap, workers);
+        eventQueue, dataMap, workers, useNIO);
     server.start();
     String contextName = jobID + "";
     // Barrier guarantees the living workers get
@@ -111,8 +126,12 @@ public class AllreduceCollective {
     // -------------------------------------------------
     // Allreduce
     try {
+      long startTime = System.currentTimeMillis();
       allreduce(contextName, "allreduce", table,
-        dataMap, workers);
+        dataMap, workers, mode);
+      LOG.info("Allreduce time (ms): "
+        + (System.currentTimeMillis()
+          - startTime));
     } catch (Exception e) {
       LOG.error("Fail to allreduce", e);
     }
@@ -138,7 +157,9 @@ public class AllreduceCollective {
   }
 
   /**
-   * Allreduce communication operation.
+   * Allreduce communication operation through
+   * recursive halving. The workers may hold
+   * different partitions.
    * 
    * @param contextName
    *          the name of the context
@@ -157,6 +178,149 @@ public class AllreduceCollective {
       final String operationName,
       final Table<P> table, final DataMap dataMap,
       final Workers workers) {
+    return recursiveHalvingAllreduce(contextName,
+      operationName, table, dataMap, workers);
+  }
+
+  /**
+   * Allreduce communication operation with the
+   * given algorithm. With AUTO, the workers first
+   * agree on the algorithm through a small
+   * allreduce of their table sizes, so every
+   * worker takes the same one.
+   * 
+   * @param contextName
+   *          the name of the context
+   * @param operationName
+   *          the name of the operation
+   * @param table
+   *          the data Table
+   * @param dataMap
+   *          the DataMap
+   * @param workers
+   *          the Workers
+   * @param mode
+   *          the allreduce algorithm
+   * @return true if succeeded, false otherwise
+   */
+  public static <P extends Simple> boolean
+    allreduce(final String contextName,
+      final String operationName,
+      final Table<P> table, final DataMap dataMap,
+      final Workers workers, AllreduceMode mode) {
+    if (workers.isTheOnlyWorker()) {
+      return true;
+    }
+    if (mode == null
+      || mode == AllreduceMode.AUTO) {
+      mode = selectMode(contextName,
+        operationName, table, dataMap, workers);
+      if (mode == null) {
+        table.release();
+        return false;
+      }
+    }
+    if (mode == AllreduceMode.RING) {
+      return ringAllreduce(contextName,
+        operationName, table, dataMap, workers);
+    } else {
+      return recursiveHalvingAllreduce(
+        contextName, operationName, table,
+        dataMap, workers);
+    }
+  }
+
+  /**
+   * Select the allreduce algorithm. Recursive
+   * halving takes log2(P) steps but sends the
+   * whole table in each step. Ring takes 2(P-1)
+   * steps but each worker only sends about 2x
+   * table size in total, so it is used when the
+   * table is large and can be split among the
+   * workers. The decision is made on the
+   * partition count and the size summed over all
+   * the workers, so it is the same on every
+   * worker even if the local tables differ.
+   * 
+   * @param contextName
+   *          the name of the context
+   * @param operationName
+   *          the name of the operation
+   * @param table
+   *          the data Table
+   * @param dataMap
+   *          the DataMap
+   * @param workers
+   *          the Workers
+   * @return the selected mode, null if failed
+   */
+  public static <P extends Simple> AllreduceMode
+    selectMode(final String contextName,
+      final String operationName,
+      final Table<P> table, final DataMap dataMap,
+      final Workers workers) {
+    int numWorkers = workers.getNumWorkers();
+    if (numWorkers < 3) {
+      return AllreduceMode.RECURSIVE_HALVING;
+    }
+    double[] sizes = new double[2];
+    sizes[0] = table.getNumPartitions();
+    for (Partition<P> partition : table
+      .getPartitions()) {
+      sizes[1] += partition.getNumEnocdeBytes();
+    }
+    Table<DoubleArray> sizeTable =
+      new Table<>(0, new DoubleArrPlus());
+    sizeTable.addPartition(new Partition<>(0,
+      new DoubleArray(sizes, 0, sizes.length)));
+    String selectOpName =
+      operationName + ".selectmode";
+    boolean isSuccess = recursiveHalvingAllreduce(
+      contextName, selectOpName, sizeTable,
+      dataMap, workers);
+    dataMap.cleanOperationData(contextName,
+      selectOpName);
+    if (!isSuccess) {
+      LOG.error("Fail to select the mode in "
+        + operationName);
+      return null;
+    }
+    sizes = sizeTable.getPartition(0).get().get();
+    // Average over the workers
+    double numPartitions = sizes[0] / numWorkers;
+    double numBytes = sizes[1] / numWorkers;
+    if (numPartitions >= numWorkers
+      && numBytes >= (double) Constant.PIPELINE_SIZE
+        * numWorkers) {
+      return AllreduceMode.RING;
+    } else {
+      return AllreduceMode.RECURSIVE_HALVING;
+    }
+  }
+
+  /**
+   * Allreduce through recursive halving. In each
+   * step, the worker exchanges all its partitions
+   * with the peer in the other half.
+   * 
+   * @param contextName
+   *          the name of the context
+   * @param operationName
+   *          the name of the operation
+   * @param table
+   *          the data Table
+   * @param dataMap
+   *          the DataMap
+   * @param workers
+   *          the Workers
+   * @return true if succeeded, false otherwise
+   */
+  public static <P extends Simple> boolean
+    recursiveHalvingAllreduce(
+      final String contextName,
+      final String operationName,
+      final Table<P> table, final DataMap dataMap,
+      final Workers workers) {
     if (workers.isTheOnlyWorker()) {
       return true;
     }
@@ -295,4 +459,324 @@ public class AllreduceCollective {
     }
     return true;
   }
+
+  /**
+   * Allreduce through ring reduce-scatter and
+   * ring allgather. Partitions are assigned to
+   * blocks by a Partitioner on partition IDs.
+   * In the reduce-scatter, each worker passes one
+   * block to the next worker in each step and
+   * combines the block received from the previous
+   * worker. Then each worker owns one reduced
+   * block and circulates it in the allgather. A
+   * block is sent as chunks of about
+   * Constant.PIPELINE_SIZE bytes, and a received
+   * chunk is combined and forwarded right away,
+   * so sending, receiving and combining overlap.
+   * Partitions not in the owned block are
+   * replaced by the reduced ones from other
+   * workers.
+   * 
+   * @param contextName
+   *          the name of the context
+   * @param operationName
+   *          the name of the operation
+   * @param table
+   *          the data Table
+   * @param dataMap
+   *          the DataMap
+   * @param workers
+   *          the Workers
+   * @return true if succeeded, false otherwise
+   */
+  public static <P extends Simple> boolean
+    ringAllreduce(final String contextName,
+      final String operationName,
+      final Table<P> table, final DataMap dataMap,
+      final Workers workers) {
+    if (workers.isTheOnlyWorker()) {
+      return true;
+    }
+    final int selfID = workers.getSelfID();
+    final int nextID = workers.getNextID();
+    final int prevID =
+      selfID == workers.getMinID()
+        ? workers.getMaxID() : (selfID - 1);
+    final int numWorkers = workers.getNumWorkers();
+    final int rank = selfID - workers.getMinID();
+    final Partitioner partitioner =
+      new Partitioner(numWorkers);
+    // -----------------------------------------------
+    // Reduce-scatter
+    // In step i, send block (rank - i) and receive
+    // block (rank - i - 1).
+    sendPartitionChunks(contextName,
+      operationName + ".reducescatter.0",
+      getBlockPartitions(table, partitioner, rank,
+        null),
+      0, selfID, nextID, workers);
+    for (int i = 0; i < numWorkers - 1; i++) {
+      String recvOpName =
+        operationName + ".reducescatter." + i;
+      String sendOpName = operationName
+        + ".reducescatter." + (i + 1);
+      // The block received in the last step is
+      // fully reduced and not forwarded
+      boolean isForwarding = i < numWorkers - 2;
+      int recvBlock = Math
+        .floorMod(rank - i - 1, numWorkers);
+      IntOpenHashSet forwardedIDs =
+        new IntOpenHashSet();
+      int numSendChunks = 0;
+      int numRecvChunks = 0;
+      int numTotalChunks = 0;
+      do {
+        Data recvData = IOUtil.waitAndGet(dataMap,
+          contextName, recvOpName);
+        if (recvData == null) {
+          LOG.error("Fail to receive chunks from "
+            + prevID + " in " + recvOpName);
+          table.release();
+          return false;
+        }
+        recvData.releaseHeadArray();
+        recvData.releaseBodyArray();
+        numRecvChunks++;
+        if (recvData.getPartitionID() > 0) {
+          numTotalChunks =
+            recvData.getPartitionID();
+        }
+        List<Transferable> recvPartitions =
+          recvData.getBody();
+        IntArrayList recvIDs = new IntArrayList(
+          recvPartitions.size());
+        for (Transferable trans : recvPartitions) {
+          recvIDs
+            .add(((Partition<?>) trans).id());
+        }
+        PartitionUtil.addPartitionsToTable(
+          recvPartitions, table);
+        if (isForwarding && !recvIDs.isEmpty()) {
+          List<Transferable> sendPartitions =
+            new LinkedList<>();
+          for (int partitionID : recvIDs) {
+            if (forwardedIDs.add(partitionID)) {
+              sendPartitions.add(
+                table.getPartition(partitionID));
+            }
+          }
+          sendPartitionChunk(contextName,
+            sendOpName, sendPartitions, 0, selfID,
+            nextID, workers);
+          numSendChunks++;
+        }
+      } while (numTotalChunks == 0
+        || numRecvChunks < numTotalChunks);
+      if (isForwarding) {
+        // Send the local partitions of this block
+        // which the previous worker doesn't have
+        sendPartitionChunks(contextName,
+          sendOpName,
+          getBlockPartitions(table, partitioner,
+            recvBlock, forwardedIDs),
+          numSendChunks, selfID, nextID, workers);
+      }
+      dataMap.cleanOperationData(contextName,
+        recvOpName);
+    }
+    // -----------------------------------------------
+    // Allgather
+    // Keep the reduced block and drop the partial
+    // results of the other blocks
+    final int ownedBlock =
+      Math.floorMod(rank + 1, numWorkers);
+    IntArrayList rmPartitionIDs =
+      new IntArrayList();
+    for (Partition<P> partition : table
+      .getPartitions()) {
+      if (partitioner.getWorkerID(
+        partition.id()) != ownedBlock) {
+        rmPartitionIDs.add(partition.id());
+      }
+    }
+    for (int partitionID : rmPartitionIDs) {
+      table.removePartition(partitionID)
+        .release();
+    }
+    String allgatherOpName =
+      operationName + ".allgather";
+    sendPartitionChunks(contextName,
+      allgatherOpName,
+      new LinkedList<>(table.getPartitions()), 0,
+      selfID, nextID, workers);
+    // Count the chunks from each worker
+    Int2IntOpenHashMap numRecvChunks =
+      new Int2IntOpenHashMap();
+    Int2IntOpenHashMap numTotalChunks =
+      new Int2IntOpenHashMap();
+    int numFinishedWorkers = 0;
+    while (numFinishedWorkers < numWorkers - 1) {
+      Data recvData = IOUtil.waitAndGet(dataMap,
+        contextName, allgatherOpName);
+      if (recvData == null) {
+        LOG.error("Fail to receive chunks from "
+          + prevID + " in " + allgatherOpName);
+        table.release();
+        return false;
+      }
+      int originID = recvData.getWorkerID();
+      // Continue sending to the next neighbor
+      if (originID != nextID) {
+        DataSender sender = new DataSender(
+          recvData, nextID, workers,
+          Constant.SEND_DECODE);
+        sender.execute();
+      }
+      recvData.releaseHeadArray();
+      recvData.releaseBodyArray();
+      if (recvData.getPartitionID() > 0) {
+        numTotalChunks.put(originID,
+          recvData.getPartitionID());
+      }
+      int numChunks =
+        numRecvChunks.addTo(originID, 1) + 1;
+      if (numChunks == numTotalChunks
+        .get(originID)) {
+        numFinishedWorkers++;
+      }
+      PartitionUtil.addPartitionsToTable(
+        recvData.getBody(), table);
+    }
+    dataMap.cleanOperationData(contextName,
+      allgatherOpName);
+    return true;
+  }
+
+  /**
+   * Get the partitions in a block
+   * 
+   * @param table
+   *          the data Table
+   * @param partitioner
+   *          the Partitioner maps partitions to
+   *          blocks
+   * @param block
+   *          the block ID
+   * @param excludedIDs
+   *          the partition IDs to skip, can be
+   *          null
+   * @return the partitions in the block
+   */
+  private static <P extends Simple>
+    List<Transferable> getBlockPartitions(
+      final Table<P> table,
+      final Partitioner partitioner,
+      final int block,
+      final IntOpenHashSet excludedIDs) {
+    List<Transferable> partitions =
+      new LinkedList<>();
+    for (Partition<P> partition : table
+      .getPartitions()) {
+      if (partitioner.getWorkerID(
+        partition.id()) == block
+        && (excludedIDs == null || !excludedIDs
+          .contains(partition.id()))) {
+        partitions.add(partition);
+      }
+    }
+    return partitions;
+  }
+
+  /**
+   * Send the partitions as chunks of about
+   * Constant.PIPELINE_SIZE bytes. The last chunk
+   * is always sent (even if it is empty) and
+   * carries the total number of chunks in the
+   * partition ID field, so the receiver knows
+   * when the block is complete.
+   * 
+   * @param contextName
+   *          the name of the context
+   * @param operationName
+   *          the name of the operation
+   * @param partitions
+   *          the partitions to send
+   * @param numSentChunks
+   *          the number of chunks already sent
+   *          in this operation
+   * @param selfID
+   *          the ID of this worker
+   * @param destID
+   *          the ID of the destination worker
+   * @param workers
+   *          the Workers
+   */
+  private static void sendPartitionChunks(
+    final String contextName,
+    final String operationName,
+    final List<Transferable> partitions,
+    int numSentChunks, final int selfID,
+    final int destID, final Workers workers) {
+    List<Transferable> chunk = new LinkedList<>();
+    int chunkBytes = 0;
+    Iterator<Transferable> iterator =
+      partitions.iterator();
+    while (iterator.hasNext()) {
+      Transferable partition = iterator.next();
+      chunk.add(partition);
+      chunkBytes += partition.getNumEnocdeBytes();
+      if (chunkBytes >= Constant.PIPELINE_SIZE
+        && iterator.hasNext()) {
+        sendPartitionChunk(contextName,
+          operationName, chunk, 0, selfID, destID,
+          workers);
+        numSentChunks++;
+        chunk = new LinkedList<>();
+        chunkBytes = 0;
+      }
+    }
+    numSentChunks++;
+    sendPartitionChunk(contextName, operationName,
+      chunk, numSentChunks, selfID, destID,
+      workers);
+  }
+
+  /**
+   * Send a chunk of partitions
+   * 
+   * @param contextName
+   *          the name of the context
+   * @param operationName
+   *          the name of the operation
+   * @param chunk
+   *          the partitions in this chunk
+   * @param numTotalChunks
+   *          the total number of chunks if this
+   *          is the last chunk, otherwise 0
+   * @param selfID
+   *          the ID of this worker
+   * @param destID
+   *          the ID of the destination worker
+   * @param workers
+   *          the Workers
+   */
+  private static void sendPartitionChunk(
+    final String contextName,
+    final String operationName,
+    final List<Transferable> chunk,
+    final int numTotalChunks, final int selfID,
+    final int destID, final Workers workers) {
+    Data sendData =
+      new Data(DataType.PARTITION_LIST,
+        contextName, selfID, chunk,
+        DataUtil.getNumTransListBytes(chunk),
+        operationName, numTotalChunks);
+    DataSender sender = new DataSender(sendData,
+      destID, workers, Constant.SEND_DECODE);
+    sender.execute();
+    // Release the encoded arrays only, the
+    // partitions are still in the table
+    sendData.releaseHeadArray();
+    sendData.releaseBodyArray();
+  }
 }
@@ -0,0 +1,27 @@
+/*
+ * Copyright 2013-2017 Indiana University
+ * 
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+package edu.iu.harp.collective;
+
+/*******************************************************
+ * The algorithms used by allreduce. AUTO lets
+ * the workers agree on one from the total table
+ * size and the number of workers. Allreduce
+ * without a mode uses RECURSIVE_HALVING.
+ ******************************************************/
+public enum AllreduceMode {
+  AUTO, RECURSIVE_HALVING, RING
+}
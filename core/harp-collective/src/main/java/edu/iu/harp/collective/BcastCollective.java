@@ -62,11 +62,16 @@ public class BcastCollective {
     long jobID = Long.parseLong(args[3]);
     int numBytes = Integer.parseInt(args[4]);
     int numLoops = Integer.parseInt(args[5]);
+    // Use NIO transport if the optional argument
+    // is "nio"
+    boolean useNIO =
+      args.length > 6 && args[6].equals("nio");
     // Initialize log
     Driver.initLogger(workerID);
     LOG.info("args[] " + driverHost + " "
       + driverPort + " " + workerID + " " + jobID
-      + " " + numBytes + " " + numLoops);
+      + " " + numBytes + " " + numLoops + " "
+      + useNIO);
     // ------------------------------------------
     // Worker initialize
     EventQueue eventQueue = new EventQueue();
@@ -74,8 +79,9 @@ public class BcastCollective {
     Workers workers = new Workers(workerID);
     String host = workers.getSelfInfo().getNode();
     int port = workers.getSelfInfo().getPort();
+    ConnPool.get().setUseNIO(useNIO);
     Server server = new Server(host, port,
-      eventQueue, dataMap, workers);
+      eventQueue, dataMap, workers, useNIO);
     server.start();
     String contextName = jobID + "";
     // Barrier guarantees the living workers get
@@ -28,6 +28,7 @@ import edu.iu.harp.io.DataUtil;
 import edu.iu.harp.io.IOUtil;
 import edu.iu.harp.resource.Transferable;
 import edu.iu.harp.resource.Writable;
+import edu.iu.harp.trace.Tracer;
 import edu.iu.harp.util.Barrier;
 import edu.iu.harp.worker.WorkerInfo;
 import edu.iu.harp.worker.Workers;
@@ -63,6 +64,18 @@ public class Communication {
    * @return true if succeeded, false otherwise
    */
   public static boolean barrier(
+    String contextName, String operationName,
+    DataMap dataMap, Workers workers) {
+    return Tracer.get().traceOp(contextName,
+      operationName, "barrier",
+      () -> doBarrier(contextName, operationName,
+        dataMap, workers));
+  }
+
+  /**
+   * The barrier without tracing
+   */
+  private static boolean doBarrier(
     String contextName, String operationName,
     DataMap dataMap, Workers workers) {
     if (workers.isTheOnlyWorker()) {
@@ -207,6 +220,19 @@ public class Communication {
     String operationName, List<Transferable> objs,
     int gatherWorkerID, DataMap dataMap,
     Workers workers) {
+    return Tracer.get().traceOp(contextName,
+      operationName, "gather",
+      () -> doGather(contextName, operationName,
+        objs, gatherWorkerID, dataMap, workers));
+  }
+
+  /**
+   * The gather without tracing
+   */
+  private static boolean doGather(
+    String contextName, String operationName,
+    List<Transferable> objs, int gatherWorkerID,
+    DataMap dataMap, Workers workers) {
     if (workers.isTheOnlyWorker()) {
       return true;
     }
@@ -257,6 +283,20 @@ public class Communication {
    * @return true if succeeded, false otherwise
    */
   public static boolean allgather(
+    final String contextName,
+    final String operationName,
+    List<Transferable> objs, DataMap dataMap,
+    Workers workers) {
+    return Tracer.get().traceOp(contextName,
+      operationName, "allgather",
+      () -> doAllgather(contextName,
+        operationName, objs, dataMap, workers));
+  }
+
+  /**
+   * The allgather without tracing
+   */
+  private static boolean doAllgather(
     final String contextName,
     final String operationName,
     List<Transferable> objs, DataMap dataMap,
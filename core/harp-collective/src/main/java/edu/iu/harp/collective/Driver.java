@@ -40,6 +40,7 @@ import org.apache.log4j.Logger;
 import org.apache.log4j.PatternLayout;
 
 import java.io.File;
+import java.util.Arrays;
 import java.util.LinkedList;
 import java.util.concurrent.ForkJoinPool;
 import java.util.concurrent.TimeUnit;
@@ -112,9 +113,11 @@ public class Driver {
     if (task.equals("bcast")) {
       // args[3]: totalByteData
       // args[4]: numLoops
+      // args[5]: "nio" (optional)
       isRunning = startAllWorkers(workers,
         bcast_script, driverHost, driverPort,
-        jobID, args[3], args[4]);
+        jobID,
+        Arrays.copyOfRange(args, 3, args.length));
     } else if (task.equals("regroup")) {
       // args[3]: partitionByteData
       // args[4]: numPartitions
@@ -140,9 +143,12 @@ public class Driver {
     } else if (task.equals("allreduce")) {
       // args[3]: partitionByteData
       // args[4]: numPartitions
+      // args[5]: allreduce mode (optional)
+      // args[6]: "nio" (optional)
       isRunning = startAllWorkers(workers,
         allreduce_script, driverHost, driverPort,
-        jobID, args[3], args[4]);
+        jobID,
+        Arrays.copyOfRange(args, 3, args.length));
     } else if (task.equals("reduce")) {
       // args[3]: partitionByteData
       // args[4]: numPartitions
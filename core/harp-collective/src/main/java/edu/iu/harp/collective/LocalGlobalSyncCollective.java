@@ -35,6 +35,7 @@ import edu.iu.harp.resource.DoubleArray;
 import edu.iu.harp.resource.Simple;
 import edu.iu.harp.resource.Transferable;
 import edu.iu.harp.server.Server;
+import edu.iu.harp.trace.Tracer;
 import edu.iu.harp.util.PartitionCount;
 import edu.iu.harp.util.PartitionSet;
 import edu.iu.harp.worker.Workers;
@@ -46,6 +47,8 @@ import org.apache.log4j.Logger;
 
 import java.util.LinkedList;
 import java.util.List;
+import java.util.concurrent.ExecutorService;
+import java.util.concurrent.Executors;
 import java.util.concurrent.ForkJoinPool;
 import java.util.concurrent.TimeUnit;
 
@@ -58,6 +61,15 @@ public class LocalGlobalSyncCollective {
   private static final Logger LOG = Logger
     .getLogger(LocalGlobalSyncCollective.class);
 
+  /** Runs the asynchronous rotations */
+  private static final ExecutorService ROTATE_EXECUTOR =
+    Executors.newCachedThreadPool(runnable -> {
+      Thread thread =
+        new Thread(runnable, "harp-rotate");
+      thread.setDaemon(true);
+      return thread;
+    });
+
   public static void main(String args[])
     throws Exception {
     String driverHost = args[0];
@@ -463,6 +475,8 @@ public class LocalGlobalSyncCollective {
         DataType.PARTITION_LIST, contextName,
         selfID, localPartitions, size,
         operationName, localPartitions.size());
+      // The copy does not go on the wire
+      data.disableWireEncoding();
       data.encodeHead();
       data.encodeBody();
       final Data newData = new Data(
@@ -791,6 +805,49 @@ public class LocalGlobalSyncCollective {
     }
   }
 
+  /**
+   * Start the rotation in the background and
+   * return immediately. The table must not be
+   * accessed until the handle completes. The
+   * operation data is cleaned when the rotation
+   * is done.
+   * 
+   * @param contextName
+   *          the name of the context
+   * @param operationName
+   *          the name of the operation
+   * @param globalTable
+   *          the global Table
+   * @param rotateMap
+   *          the map indicating the order of
+   *          rotation
+   * @param dataMap
+   *          the DataMap
+   * @param workers
+   *          the Workers
+   * @return the handle of the rotation
+   */
+  public static <P extends Simple> RotateHandle
+    rotateAsync(final String contextName,
+      final String operationName,
+      final Table<P> globalTable,
+      final Int2IntMap rotateMap,
+      final DataMap dataMap,
+      final Workers workers) {
+    RotateHandle handle = new RotateHandle(() -> {
+      boolean isSuccess = Tracer.get().traceOp(
+        contextName, operationName, "rotate",
+        () -> rotate(contextName, operationName,
+          globalTable, rotateMap, dataMap,
+          workers));
+      dataMap.cleanOperationData(contextName,
+        operationName);
+      return isSuccess;
+    });
+    ROTATE_EXECUTOR.execute(handle.getRunnable());
+    return handle;
+  }
+
   /**
    * Send the local data to the destination,
    * receive the data from one of other worker
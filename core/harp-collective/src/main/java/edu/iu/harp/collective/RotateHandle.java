@@ -0,0 +1,119 @@
+/*
+ * Copyright 2013-2017 Indiana University
+ * 
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+package edu.iu.harp.collective;
+
+import org.apache.log4j.Logger;
+
+import java.util.concurrent.Callable;
+import java.util.concurrent.ExecutionException;
+import java.util.concurrent.FutureTask;
+
+/*******************************************************
+ * The handle of an asynchronous rotation. The
+ * table being rotated must not be accessed until
+ * waitForCompletion returns. The handle records
+ * how long the rotation took and how much of it
+ * was exposed, i.e. how long the caller was
+ * blocked waiting for it.
+ ******************************************************/
+public class RotateHandle {
+
+  private static final Logger LOG =
+    Logger.getLogger(RotateHandle.class);
+
+  private final FutureTask<Boolean> task;
+  private volatile long commTime;
+  private long exposedTime;
+
+  RotateHandle(final Callable<Boolean> rotation) {
+    commTime = 0L;
+    exposedTime = 0L;
+    task = new FutureTask<>(() -> {
+      long startTime = System.currentTimeMillis();
+      try {
+        return rotation.call();
+      } finally {
+        commTime = System.currentTimeMillis()
+          - startTime;
+      }
+    });
+  }
+
+  /**
+   * Get the runnable executing the rotation
+   * 
+   * @return the runnable
+   */
+  Runnable getRunnable() {
+    return task;
+  }
+
+  /**
+   * Check if the rotation is done
+   * 
+   * @return true if done, false otherwise
+   */
+  public boolean isDone() {
+    return task.isDone();
+  }
+
+  /**
+   * Block until the rotation is done
+   * 
+   * @return true if succeeded, false otherwise
+   */
+  public boolean waitForCompletion() {
+    long startTime = System.currentTimeMillis();
+    boolean isSuccess = false;
+    boolean isFailed = false;
+    do {
+      try {
+        isSuccess = task.get();
+        isFailed = false;
+      } catch (InterruptedException e) {
+        LOG.error("Error when waiting rotation", e);
+        isFailed = true;
+      } catch (ExecutionException e) {
+        LOG.error("Fail to rotate", e.getCause());
+        isSuccess = false;
+        isFailed = false;
+      }
+    } while (isFailed);
+    exposedTime +=
+      System.currentTimeMillis() - startTime;
+    return isSuccess;
+  }
+
+  /**
+   * Get the time of the rotation in
+   * milliseconds, 0 if not done
+   * 
+   * @return the rotation time
+   */
+  public long getCommTime() {
+    return commTime;
+  }
+
+  /**
+   * Get the time the caller was blocked in
+   * waitForCompletion in milliseconds
+   * 
+   * @return the exposed rotation time
+   */
+  public long getExposedTime() {
+    return exposedTime;
+  }
+}
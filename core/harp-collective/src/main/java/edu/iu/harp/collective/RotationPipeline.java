@@ -0,0 +1,174 @@
+/*
+ * Copyright 2013-2017 Indiana University
+ * 
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+package edu.iu.harp.collective;
+
+import edu.iu.harp.io.DataMap;
+import edu.iu.harp.partition.Table;
+import edu.iu.harp.resource.Simple;
+import edu.iu.harp.worker.Workers;
+import it.unimi.dsi.fastutil.ints.Int2IntMap;
+import org.apache.log4j.Logger;
+
+/*******************************************************
+ * Double-buffered rotation of a model split into
+ * slices. After computing on a slice, call
+ * rotate(sliceID) to send it on in the
+ * background, and getSlice(sliceID) before
+ * computing on it again. With two or more
+ * slices, the next slice streams in while the
+ * current one is computed. Only rotation time
+ * that is not hidden behind computation is
+ * counted as exposed.
+ * 
+ * Every worker must rotate the slices in the
+ * same order. The pipeline is driven by one
+ * thread.
+ ******************************************************/
+public class RotationPipeline<P extends Simple> {
+
+  private static final Logger LOG =
+    Logger.getLogger(RotationPipeline.class);
+
+  private final String contextName;
+  private final Table<P>[] slices;
+  private final RotateHandle[] handles;
+  private final int[] operationIDs;
+  private final DataMap dataMap;
+  private final Workers workers;
+  private long commTime;
+  private long exposedTime;
+
+  public RotationPipeline(String contextName,
+    Table<P>[] slices, DataMap dataMap,
+    Workers workers) {
+    this.contextName = contextName;
+    this.slices = slices;
+    handles = new RotateHandle[slices.length];
+    operationIDs = new int[slices.length];
+    this.dataMap = dataMap;
+    this.workers = workers;
+    commTime = 0L;
+    exposedTime = 0L;
+  }
+
+  /**
+   * Get the number of slices
+   * 
+   * @return the number of slices
+   */
+  public int getNumSlices() {
+    return slices.length;
+  }
+
+  /**
+   * Start rotating a slice to the next worker
+   * 
+   * @param sliceID
+   *          the ID of the slice
+   */
+  public void rotate(int sliceID) {
+    rotate(sliceID, null);
+  }
+
+  /**
+   * Start rotating a slice
+   * 
+   * @param sliceID
+   *          the ID of the slice
+   * @param rotateMap
+   *          the map from worker to worker, null
+   *          to rotate to the next worker
+   */
+  public void rotate(int sliceID,
+    Int2IntMap rotateMap) {
+    // A slice can only be in one rotation
+    waitForSlice(sliceID);
+    handles[sliceID] = LocalGlobalSyncCollective
+      .rotateAsync(contextName,
+        "rotate-" + slices[sliceID].getTableID()
+          + "-" + sliceID + "-"
+          + operationIDs[sliceID],
+        slices[sliceID], rotateMap, dataMap,
+        workers);
+    operationIDs[sliceID]++;
+  }
+
+  /**
+   * Get a slice, wait if it is being rotated
+   * 
+   * @param sliceID
+   *          the ID of the slice
+   * @return the slice
+   */
+  public Table<P> getSlice(int sliceID) {
+    waitForSlice(sliceID);
+    return slices[sliceID];
+  }
+
+  /**
+   * Wait for all the slices
+   * 
+   * @return true if all the rotations succeeded,
+   *         false otherwise
+   */
+  public boolean waitForAll() {
+    boolean isSuccess = true;
+    for (int i = 0; i < slices.length; i++) {
+      isSuccess &= waitForSlice(i);
+    }
+    return isSuccess;
+  }
+
+  private boolean waitForSlice(int sliceID) {
+    RotateHandle handle = handles[sliceID];
+    if (handle == null) {
+      return true;
+    }
+    boolean isSuccess = handle.waitForCompletion();
+    if (!isSuccess) {
+      LOG.error("Fail to rotate slice " + sliceID);
+    }
+    commTime += handle.getCommTime();
+    exposedTime += handle.getExposedTime();
+    handles[sliceID] = null;
+    return isSuccess;
+  }
+
+  /**
+   * Get and reset the total rotation time
+   * 
+   * @return the total rotation time in
+   *         milliseconds
+   */
+  public long resetCommTime() {
+    long time = commTime;
+    commTime = 0L;
+    return time;
+  }
+
+  /**
+   * Get and reset the rotation time not hidden
+   * behind computation
+   * 
+   * @return the exposed rotation time in
+   *         milliseconds
+   */
+  public long resetExposedTime() {
+    long time = exposedTime;
+    exposedTime = 0L;
+    return time;
+  }
+}
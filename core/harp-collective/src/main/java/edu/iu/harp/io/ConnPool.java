@@ -37,6 +37,9 @@ public class ConnPool {
   private Object2ObjectOpenHashMap<HostPort, Pool> connMap =
     new Object2ObjectOpenHashMap<>();
 
+  /** If new connections are based on NIO */
+  private volatile boolean useNIO = false;
+
   /*******************************************************
    * The class for host and port information
    ******************************************************/
@@ -114,6 +117,28 @@ public class ConnPool {
     return instance;
   }
 
+  /**
+   * Set if new connections are based on NIO
+   * channels. The cached connections are not
+   * affected.
+   * 
+   * @param useNIO
+   *          use NIO or not
+   */
+  public void setUseNIO(boolean useNIO) {
+    this.useNIO = useNIO;
+  }
+
+  /**
+   * Check if new connections are based on NIO
+   * channels
+   * 
+   * @return true if NIO is used
+   */
+  public boolean isNIOUsed() {
+    return this.useNIO;
+  }
+
   /**
    * Get a connection object by host and port
    * information.
@@ -174,8 +199,8 @@ public class ConnPool {
     do {
       isFailed = false;
       try {
-        conn =
-          new Connection(host, port, 0, useCache);
+        conn = new Connection(host, port, 0,
+          useCache, useNIO);
       } catch (Exception e) {
         isFailed = true;
         count++;
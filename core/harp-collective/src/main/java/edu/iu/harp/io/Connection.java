@@ -23,6 +23,8 @@ import java.net.InetAddress;
 import java.net.InetSocketAddress;
 import java.net.Socket;
 import java.net.SocketAddress;
+import java.nio.channels.Channels;
+import java.nio.channels.SocketChannel;
 
 /*******************************************************
  * The connection object as a client
@@ -34,6 +36,8 @@ public class Connection {
   private OutputStream out;
   private InputStream in;
   private Socket socket;
+  /** The channel, null if NIO is not used */
+  private SocketChannel channel;
   private final boolean useCache;
 
   /**
@@ -52,6 +56,30 @@ public class Connection {
    */
   Connection(String node, int port, int timeOutMs,
     boolean useCache) throws Exception {
+    this(node, port, timeOutMs, useCache, false);
+  }
+
+  /**
+   * Construct a connection
+   * 
+   * @param node
+   *          the host
+   * @param port
+   *          the port
+   * @param timeOutMs
+   *          the timeout value to be used in
+   *          milliseconds.
+   * @param useCache
+   *          use cache or not
+   * @param useNIO
+   *          if the connection is based on a
+   *          blocking SocketChannel, which
+   *          supports gathering writes
+   * @throws Exception
+   */
+  Connection(String node, int port, int timeOutMs,
+    boolean useCache, boolean useNIO)
+    throws Exception {
     this.node = node;
     this.port = port;
     this.useCache = useCache;
@@ -60,11 +88,22 @@ public class Connection {
         InetAddress.getByName(node);
       SocketAddress sockaddr =
         new InetSocketAddress(addr, port);
-      this.socket = new Socket();
+      if (useNIO) {
+        this.channel = SocketChannel.open();
+        this.socket = channel.socket();
+      } else {
+        this.channel = null;
+        this.socket = new Socket();
+      }
       IOUtil.setSocketOptions(socket);
       this.socket.connect(sockaddr, timeOutMs);
-      this.out = socket.getOutputStream();
-      this.in = socket.getInputStream();
+      if (useNIO) {
+        this.out = Channels.newOutputStream(channel);
+        this.in = Channels.newInputStream(channel);
+      } else {
+        this.out = socket.getOutputStream();
+        this.in = socket.getInputStream();
+      }
     } catch (Exception e) {
       close();
       throw e;
@@ -107,6 +146,16 @@ public class Connection {
     return this.in;
   }
 
+  /**
+   * Get the SocketChannel
+   * 
+   * @return the SocketChannel, null if NIO is not
+   *         used
+   */
+  public SocketChannel getChannel() {
+    return this.channel;
+  }
+
   /**
    * Close the connection
    */
@@ -134,6 +183,7 @@ public class Connection {
       out = null;
       in = null;
       socket = null;
+      channel = null;
     }
   }
 
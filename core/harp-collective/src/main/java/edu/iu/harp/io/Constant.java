@@ -54,6 +54,8 @@ public class Constant {
 
   public static final int NUM_THREADS =
     Runtime.getRuntime().availableProcessors();
+  // The number of selector threads in NIOServer
+  public static final int NUM_SELECTORS = 2;
   public static final int DEFAULT_WORKER_POART_BASE =
     12800;
 
@@ -49,6 +49,10 @@ public class Data {
   private int bodySize = 0;
   /** Data object contained */
   private List<Transferable> body = null;
+  /** If the body uses the wire encodings */
+  private boolean isBodyEncoded = false;
+  /** If the body may use the wire encodings */
+  private boolean isWireEncodable = true;
 
   private ByteArray headArray = null;
   private ByteArray bodyArray = null;
@@ -194,6 +198,7 @@ public class Data {
     partitionID = Constant.UNKNOWN_PARTITION_ID;
     bodySize = 0;
     body = null;
+    isBodyEncoded = false;
   }
 
   /**
@@ -380,7 +385,11 @@ public class Data {
         new Deserializer(headArray);
       boolean isFailed = false;
       try {
-        bodyType = deserializer.readByte();
+        byte type = deserializer.readByte();
+        isBodyEncoded =
+          (type & DataType.ENCODED_BODY) != 0;
+        bodyType =
+          (byte) (type & ~DataType.ENCODED_BODY);
         // LOG.info("body type: " + bodyType);
         contextName = deserializer.readUTF();
         workerID = deserializer.readInt();
@@ -443,6 +452,7 @@ public class Data {
     bodySize = 0;
     operationName = null;
     partitionID = Constant.UNKNOWN_PARTITION_ID;
+    isBodyEncoded = false;
   }
 
   /**
@@ -459,11 +469,11 @@ public class Data {
       // body array cannot be null.
       // body object must be null;
       if (bodyType == DataType.SIMPLE_LIST) {
-        body =
-          DataUtil.decodeSimpleList(bodyArray);
+        body = DataUtil.decodeSimpleList(bodyArray,
+          isBodyEncoded);
       } else if (bodyType == DataType.PARTITION_LIST) {
-        body =
-          DataUtil.decodePartitionList(bodyArray);
+        body = DataUtil.decodePartitionList(
+          bodyArray, isBodyEncoded);
       } else {
         LOG.error("Cannot decode unknown body: "
           + bodyType);
@@ -479,6 +489,16 @@ public class Data {
     return bodyStatus;
   }
 
+  /**
+   * Keep the plain encoding of the body. This is
+   * for the data copied locally, which is never
+   * sent, so the wire encodings only cost time
+   * and may lose precision.
+   */
+  public void disableWireEncoding() {
+    isWireEncodable = false;
+  }
+
   /**
    * Encode the head as a ByteArray
    * 
@@ -486,6 +506,13 @@ public class Data {
    */
   public DataStatus encodeHead() {
     if (headStatus == DataStatus.DECODED) {
+      if (isWireEncodable
+        && WireEncoding.isEnabled()
+        && bodyStatus == DataStatus.DECODED) {
+        // The body size in the head is the size
+        // of the encoded body
+        encodeBody();
+      }
       // Encode fields to head array
       boolean isOpData = isOperationData();
       boolean isParData = isPartitionData();
@@ -505,7 +532,9 @@ public class Data {
         new Serializer(headArray);
       boolean isFailed = false;
       try {
-        serializer.writeByte(bodyType);
+        serializer.writeByte(isBodyEncoded
+          ? bodyType | DataType.ENCODED_BODY
+          : bodyType);
         serializer.writeUTF(contextName);
         serializer.writeInt(workerID);
         serializer.writeInt(bodySize);
@@ -557,6 +586,24 @@ public class Data {
    * @return the DataStatus
    */
   public DataStatus encodeBody() {
+    if (bodyStatus == DataStatus.DECODED
+      && headStatus == DataStatus.DECODED
+      && isWireEncodable
+      && WireEncoding.isEnabled()
+      && (bodyType == DataType.SIMPLE_LIST
+        || bodyType == DataType.PARTITION_LIST)
+      && !body.isEmpty()) {
+      // The head is not encoded yet, so the body
+      // size can be changed
+      bodyArray = WireEncoding
+        .encodeTransList(body, contextName);
+      if (bodyArray != null) {
+        bodySize = bodyArray.size();
+        isBodyEncoded = true;
+        bodyStatus =
+          DataStatus.ENCODED_ARRAY_DECODED;
+      }
+    }
     if (bodyStatus == DataStatus.DECODED) {
       if (headStatus == DataStatus.DECODED
         || headStatus == DataStatus.ENCODED_ARRAY_DECODED
@@ -16,6 +16,7 @@
 
 package edu.iu.harp.io;
 
+import edu.iu.harp.trace.Tracer;
 import org.apache.log4j.Logger;
 
 import java.util.Map.Entry;
@@ -108,8 +109,17 @@ public class DataMap {
     BlockingQueue<Data> opDataQueue =
       createOperationDataQueue(contextName,
         operationName);
-    return opDataQueue.poll(maxWaitTime,
-      TimeUnit.SECONDS);
+    long startTime = Tracer.now();
+    Data data = null;
+    try {
+      data = opDataQueue.poll(maxWaitTime,
+        TimeUnit.SECONDS);
+    } finally {
+      Tracer.get().recordWait(contextName,
+        operationName, startTime, Tracer.now(),
+        data == null);
+    }
+    return data;
   }
 
   /**
@@ -31,4 +31,9 @@ public class DataType {
   public static final byte WRITABLE = 7;
   public static final byte SIMPLE_LIST = 8;
   public static final byte PARTITION_LIST = 9;
+  /**
+   * Set in the body type in the head if the body
+   * uses the wire encodings
+   */
+  public static final byte ENCODED_BODY = 0x40;
 }
@@ -285,6 +285,39 @@ public class DataUtil {
     }
   }
 
+  /**
+   * Deserialize the data from a Deserializer
+   * based on the data type
+   * 
+   * @param dataType
+   *          the data type
+   * @param din
+   *          the Deserializer
+   * @return a Simple deserialized from the
+   *         Deserializer, null if failed
+   */
+  public static Simple deserializeSimple(
+    byte dataType, Deserializer din) {
+    if (dataType == DataType.BYTE_ARRAY) {
+      return deserializeByteArray(din);
+    } else if (dataType == DataType.SHORT_ARRAY) {
+      return deserializeShortArray(din);
+    } else if (dataType == DataType.INT_ARRAY) {
+      return deserializeIntArray(din);
+    } else if (dataType == DataType.FLOAT_ARRAY) {
+      return deserializeFloatArray(din);
+    } else if (dataType == DataType.LONG_ARRAY) {
+      return deserializeLongArray(din);
+    } else if (dataType == DataType.DOUBLE_ARRAY) {
+      return deserializeDoubleArray(din);
+    } else if (dataType == DataType.WRITABLE) {
+      return deserializeWritable(din);
+    } else {
+      LOG.info("Unkown data type.");
+      return null;
+    }
+  }
+
   /**
    * Decode the ByteArray as a list of
    * Transferable objects
@@ -295,37 +328,48 @@ public class DataUtil {
    */
   public static List<Transferable>
     decodeSimpleList(final ByteArray byteArray) {
+    return decodeSimpleList(byteArray, false);
+  }
+
+  /**
+   * Decode the ByteArray as a list of
+   * Transferable objects
+   * 
+   * @param byteArray
+   *          the ByteArray to be decoded
+   * @param isEncoded
+   *          if the objects use the wire
+   *          encodings
+   * @return a list of Transferable objects
+   */
+  public static List<Transferable>
+    decodeSimpleList(final ByteArray byteArray,
+      boolean isEncoded) {
     List<Transferable> objs = new LinkedList<>();
     Deserializer decoder =
       new Deserializer(byteArray);
     while (decoder.getPos() < decoder
       .getLength()) {
+      byte codec = WireEncoding.DENSE;
       byte dataType = DataType.UNKNOWN_DATA_TYPE;
       try {
-        dataType = decoder.readByte();
+        if (isEncoded) {
+          codec = decoder.readByte();
+        }
+        if (codec == WireEncoding.DENSE) {
+          dataType = decoder.readByte();
+        }
       } catch (Exception e) {
         releaseTransList(objs);
         return null;
       }
       Simple obj = null;
-      if (dataType == DataType.UNKNOWN_DATA_TYPE) {
+      if (codec != WireEncoding.DENSE) {
+        obj = WireEncoding.decode(codec, decoder);
+      } else if (dataType == DataType.UNKNOWN_DATA_TYPE) {
         break;
-      } else if (dataType == DataType.BYTE_ARRAY) {
-        obj = deserializeByteArray(decoder);
-      } else if (dataType == DataType.SHORT_ARRAY) {
-        obj = deserializeShortArray(decoder);
-      } else if (dataType == DataType.INT_ARRAY) {
-        obj = deserializeIntArray(decoder);
-      } else if (dataType == DataType.FLOAT_ARRAY) {
-        obj = deserializeFloatArray(decoder);
-      } else if (dataType == DataType.LONG_ARRAY) {
-        obj = deserializeLongArray(decoder);
-      } else if (dataType == DataType.DOUBLE_ARRAY) {
-        obj = deserializeDoubleArray(decoder);
-      } else if (dataType == DataType.WRITABLE) {
-        obj = deserializeWritable(decoder);
       } else {
-        LOG.info("Unkown data type.");
+        obj = deserializeSimple(dataType, decoder);
       }
       if (obj == null) {
         releaseTransList(objs);
@@ -347,15 +391,37 @@ public class DataUtil {
   public static List<Transferable>
     decodePartitionList(
       final ByteArray byteArray) {
+    return decodePartitionList(byteArray, false);
+  }
+
+  /**
+   * Decode the ByteArray as a list of Partitions
+   * 
+   * @param byteArray
+   *          the ByteArray to be decoded
+   * @param isEncoded
+   *          if the partitions use the wire
+   *          encodings
+   * @return a list of Partitions
+   */
+  public static List<Transferable>
+    decodePartitionList(final ByteArray byteArray,
+      boolean isEncoded) {
     List<Transferable> partitions =
       new LinkedList<>();
     Deserializer decoder =
       new Deserializer(byteArray);
     while (decoder.getPos() < decoder
       .getLength()) {
+      byte codec = WireEncoding.DENSE;
       byte dataType = DataType.UNKNOWN_DATA_TYPE;
       try {
-        dataType = decoder.readByte();
+        if (isEncoded) {
+          codec = decoder.readByte();
+        }
+        if (codec == WireEncoding.DENSE) {
+          dataType = decoder.readByte();
+        }
       } catch (Exception e) {
         LOG.error(
           "Fail to decode partition list.", e);
@@ -363,27 +429,14 @@ public class DataUtil {
         return null;
       }
       Simple partition = null;
-      if (dataType == DataType.UNKNOWN_DATA_TYPE) {
-        break;
-      } else if (dataType == DataType.BYTE_ARRAY) {
-        partition = deserializeByteArray(decoder);
-      } else if (dataType == DataType.SHORT_ARRAY) {
-        partition =
-          deserializeShortArray(decoder);
-      } else if (dataType == DataType.INT_ARRAY) {
-        partition = deserializeIntArray(decoder);
-      } else if (dataType == DataType.FLOAT_ARRAY) {
-        partition =
-          deserializeFloatArray(decoder);
-      } else if (dataType == DataType.LONG_ARRAY) {
-        partition = deserializeLongArray(decoder);
-      } else if (dataType == DataType.DOUBLE_ARRAY) {
+      if (codec != WireEncoding.DENSE) {
         partition =
-          deserializeDoubleArray(decoder);
-      } else if (dataType == DataType.WRITABLE) {
-        partition = deserializeWritable(decoder);
+          WireEncoding.decode(codec, decoder);
+      } else if (dataType == DataType.UNKNOWN_DATA_TYPE) {
+        break;
       } else {
-        LOG.info("Unkown data type.");
+        partition =
+          deserializeSimple(dataType, decoder);
       }
       if (partition == null) {
         releaseTransList(partitions);
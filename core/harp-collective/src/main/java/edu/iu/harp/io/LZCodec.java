@@ -0,0 +1,255 @@
+/*
+ * Copyright 2013-2017 Indiana University
+ * 
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+package edu.iu.harp.io;
+
+import java.io.IOException;
+import java.util.Arrays;
+
+/*******************************************************
+ * A fast LZ77 block codec in the style of LZ4.
+ * A block is a sequence of tokens. Each token has
+ * a literal length in the high four bits and a
+ * match length minus four in the low four bits;
+ * the value 15 means more length bytes follow,
+ * each adding up to 255. The literals follow the
+ * literal length, then a two-byte little-endian
+ * match offset and the extra match length bytes.
+ * The last token only has literals.
+ ******************************************************/
+public class LZCodec {
+
+  private static final int MIN_MATCH = 4;
+  private static final int MAX_OFFSET = 65535;
+  private static final int HASH_BITS = 14;
+
+  /** The hash table of the positions, + 1 */
+  private static final ThreadLocal<int[]> tables =
+    ThreadLocal
+      .withInitial(() -> new int[1 << HASH_BITS]);
+
+  /**
+   * Compress the bytes
+   * 
+   * @param src
+   *          the source bytes
+   * @param srcOff
+   *          the start of the source bytes
+   * @param srcLen
+   *          the number of source bytes
+   * @param dst
+   *          the destination bytes
+   * @param dstOff
+   *          the start of the destination
+   * @param dstLen
+   *          the maximum number of compressed
+   *          bytes
+   * @return the number of compressed bytes, -1 if
+   *         they do not fit in dstLen
+   */
+  public static int compress(byte[] src,
+    int srcOff, int srcLen, byte[] dst,
+    int dstOff, int dstLen) {
+    int[] table = tables.get();
+    Arrays.fill(table, 0);
+    int srcEnd = srcOff + srcLen;
+    int matchLimit = srcEnd - MIN_MATCH;
+    int dstEnd = dstOff + dstLen;
+    int anchor = srcOff;
+    int ip = srcOff;
+    int op = dstOff;
+    while (ip <= matchLimit) {
+      int seq = readInt(src, ip);
+      int h = hash(seq);
+      int ref = table[h] - 1;
+      table[h] = ip - srcOff + 1;
+      if (ref < 0 || ip - (srcOff + ref) > MAX_OFFSET
+        || readInt(src, srcOff + ref) != seq) {
+        ip++;
+        continue;
+      }
+      ref += srcOff;
+      // Extend the match
+      int matchLen = MIN_MATCH;
+      while (ip + matchLen < srcEnd
+        && src[ip + matchLen] == src[ref
+          + matchLen]) {
+        matchLen++;
+      }
+      op = writeSequence(src, anchor, ip - anchor,
+        ip - ref, matchLen, dst, op, dstEnd);
+      if (op < 0) {
+        return -1;
+      }
+      ip += matchLen;
+      anchor = ip;
+    }
+    op = writeSequence(src, anchor,
+      srcEnd - anchor, 0, 0, dst, op, dstEnd);
+    if (op < 0) {
+      return -1;
+    }
+    return op - dstOff;
+  }
+
+  /**
+   * Write a token, the literals and the match
+   * 
+   * @return the next position in the
+   *         destination, -1 if it is full
+   */
+  private static int writeSequence(byte[] src,
+    int litOff, int litLen, int offset,
+    int matchLen, byte[] dst, int op,
+    int dstEnd) {
+    int extra = matchLen == 0 ? 0
+      : matchLen - MIN_MATCH;
+    // Token, lengths, literals and offset
+    int maxLen = 1 + litLen / 255 + 1 + litLen
+      + (matchLen == 0 ? 0
+        : 2 + extra / 255 + 1);
+    if (op + maxLen > dstEnd) {
+      return -1;
+    }
+    int token =
+      (Math.min(litLen, 15) << 4)
+        | Math.min(extra, 15);
+    dst[op++] = (byte) token;
+    if (litLen >= 15) {
+      op = writeLength(litLen - 15, dst, op);
+    }
+    System.arraycopy(src, litOff, dst, op,
+      litLen);
+    op += litLen;
+    if (matchLen != 0) {
+      dst[op++] = (byte) offset;
+      dst[op++] = (byte) (offset >>> 8);
+      if (extra >= 15) {
+        op = writeLength(extra - 15, dst, op);
+      }
+    }
+    return op;
+  }
+
+  private static int writeLength(int len,
+    byte[] dst, int op) {
+    while (len >= 255) {
+      dst[op++] = (byte) 255;
+      len -= 255;
+    }
+    dst[op++] = (byte) len;
+    return op;
+  }
+
+  /**
+   * Decompress the bytes
+   * 
+   * @param src
+   *          the compressed bytes
+   * @param srcOff
+   *          the start of the compressed bytes
+   * @param srcLen
+   *          the number of compressed bytes
+   * @param dst
+   *          the destination bytes
+   * @param dstOff
+   *          the start of the destination
+   * @param dstLen
+   *          the number of decompressed bytes
+   * @throws IOException
+   *           if the block is corrupted
+   */
+  public static void decompress(byte[] src,
+    int srcOff, int srcLen, byte[] dst,
+    int dstOff, int dstLen) throws IOException {
+    int srcEnd = srcOff + srcLen;
+    int dstEnd = dstOff + dstLen;
+    int ip = srcOff;
+    int op = dstOff;
+    while (ip < srcEnd) {
+      int token = src[ip++] & 0xFF;
+      int litLen = token >>> 4;
+      if (litLen == 15) {
+        int b;
+        do {
+          if (ip >= srcEnd) {
+            throw new IOException(
+              "Corrupted LZ block.");
+          }
+          b = src[ip++] & 0xFF;
+          litLen += b;
+        } while (b == 255);
+      }
+      if (ip + litLen > srcEnd
+        || op + litLen > dstEnd) {
+        throw new IOException(
+          "Corrupted LZ block.");
+      }
+      System.arraycopy(src, ip, dst, op, litLen);
+      ip += litLen;
+      op += litLen;
+      if (ip == srcEnd) {
+        break;
+      }
+      if (ip + 2 > srcEnd) {
+        throw new IOException(
+          "Corrupted LZ block.");
+      }
+      int offset = (src[ip] & 0xFF)
+        | ((src[ip + 1] & 0xFF) << 8);
+      ip += 2;
+      int matchLen = token & 0x0F;
+      if (matchLen == 15) {
+        int b;
+        do {
+          if (ip >= srcEnd) {
+            throw new IOException(
+              "Corrupted LZ block.");
+          }
+          b = src[ip++] & 0xFF;
+          matchLen += b;
+        } while (b == 255);
+      }
+      matchLen += MIN_MATCH;
+      int ref = op - offset;
+      if (offset == 0 || ref < dstOff
+        || op + matchLen > dstEnd) {
+        throw new IOException(
+          "Corrupted LZ block.");
+      }
+      // The match may overlap the output
+      for (int i = 0; i < matchLen; i++) {
+        dst[op++] = dst[ref++];
+      }
+    }
+    if (op != dstEnd) {
+      throw new IOException(
+        "Corrupted LZ block.");
+    }
+  }
+
+  private static int readInt(byte[] b, int i) {
+    return (b[i] & 0xFF)
+      | ((b[i + 1] & 0xFF) << 8)
+      | ((b[i + 2] & 0xFF) << 16)
+      | ((b[i + 3] & 0xFF) << 24);
+  }
+
+  private static int hash(int seq) {
+    return (seq * -1640531535) >>> (32
+      - HASH_BITS);
+  }
+}
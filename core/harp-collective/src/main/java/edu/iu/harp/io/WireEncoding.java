@@ -0,0 +1,947 @@
+/*
+ * Copyright 2013-2017 Indiana University
+ * 
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+package edu.iu.harp.io;
+
+import edu.iu.harp.partition.Partition;
+import edu.iu.harp.resource.ByteArray;
+import edu.iu.harp.resource.DoubleArray;
+import edu.iu.harp.resource.FloatArray;
+import edu.iu.harp.resource.IntArray;
+import edu.iu.harp.resource.LongArray;
+import edu.iu.harp.resource.Simple;
+import edu.iu.harp.resource.Transferable;
+import org.apache.log4j.Logger;
+
+import java.io.IOException;
+import java.util.Arrays;
+import java.util.List;
+import java.util.concurrent.ConcurrentHashMap;
+import java.util.concurrent.ConcurrentMap;
+
+/*******************************************************
+ * The compressed encodings of the data body. If
+ * they are used, DataType.ENCODED_BODY is set in
+ * the body type in the head, and each object in
+ * the body starts with a codec byte. A dense
+ * object is followed by its normal encoding. The
+ * other objects are followed by the data type and
+ * the array size, then:
+ * 
+ * SPARSE: the number of non-zeros, then the
+ * varint index gaps and the values.
+ * 
+ * DELTA_VARINT: the zigzag varints of the
+ * differences between int or long values.
+ * 
+ * LZ: the size of the normal encoding, the
+ * compressed size and the LZ block, without the
+ * data type and the array size.
+ * 
+ * Float and double values can be down-cast to
+ * FLOAT16 or BFLOAT16 per context. The encoding
+ * of each object is chosen by the encoded size.
+ ******************************************************/
+public class WireEncoding {
+
+  private static final Logger LOG =
+    Logger.getLogger(WireEncoding.class);
+
+  // Layouts, in the low four bits of the codec
+  public static final byte DENSE = 0;
+  public static final byte SPARSE = 1;
+  public static final byte DELTA_VARINT = 2;
+  public static final byte LZ = 3;
+  // Precisions of float and double values, in
+  // the high four bits of the codec
+  public static final byte FULL = 0;
+  public static final byte FLOAT16 = 0x10;
+  public static final byte BFLOAT16 = 0x20;
+
+  private static final int LAYOUT_MASK = 0x0F;
+  private static final int PRECISION_MASK = 0x30;
+  /** Smaller arrays are sent dense */
+  private static final int MIN_ELEMENTS = 32;
+  /** Smaller objects are not compressed */
+  private static final int MIN_LZ_BYTES = 1024;
+  /** The largest finite float16 value */
+  private static final double MAX_FLOAT16 =
+    65504.0;
+
+  private static volatile boolean isEnabled =
+    false;
+  private static final ConcurrentMap<String, Byte> precisions =
+    new ConcurrentHashMap<>();
+
+  /**
+   * Enable or disable the encodings on this
+   * worker. Received data is always decoded
+   * based on its head.
+   * 
+   * @param enabled
+   *          if the encodings are used
+   */
+  public static void setEnabled(boolean enabled) {
+    isEnabled = enabled;
+  }
+
+  public static boolean isEnabled() {
+    return isEnabled;
+  }
+
+  /**
+   * Set the precision of the float and double
+   * arrays sent in a context. The down-cast is
+   * lossy, use it for data like gradients or
+   * model updates. FLOAT16 falls back to BFLOAT16
+   * for arrays out of the float16 range.
+   * 
+   * @param contextName
+   *          the name of the context
+   * @param precision
+   *          FULL, FLOAT16 or BFLOAT16
+   */
+  public static void setPrecision(
+    String contextName, byte precision) {
+    if (precision == FULL) {
+      precisions.remove(contextName);
+    } else {
+      precisions.put(contextName, precision);
+    }
+  }
+
+  /**
+   * Get the precision of the float and double
+   * arrays sent in a context
+   * 
+   * @param contextName
+   *          the name of the context
+   * @return the precision
+   */
+  public static byte getPrecision(
+    String contextName) {
+    if (contextName == null
+      || precisions.isEmpty()) {
+      return FULL;
+    }
+    Byte precision = precisions.get(contextName);
+    return precision == null ? FULL : precision;
+  }
+
+  /**
+   * Encode the objects
+   * 
+   * @param objs
+   *          the objects
+   * @param contextName
+   *          the name of the context
+   * @return the encoded bytes, null if failed
+   */
+  public static ByteArray encodeTransList(
+    List<Transferable> objs, String contextName) {
+    // Each object is at most one byte longer
+    // than its normal encoding
+    int maxSize = DataUtil.getNumTransListBytes(objs)
+      + objs.size();
+    ByteArray byteArray =
+      ByteArray.create(maxSize, true);
+    if (byteArray == null) {
+      return null;
+    }
+    byte precision = getPrecision(contextName);
+    Serializer serializer =
+      new Serializer(byteArray);
+    try {
+      for (Transferable obj : objs) {
+        if (obj instanceof Partition) {
+          Partition<?> partition =
+            (Partition<?>) obj;
+          encodeObject(partition.get(), precision,
+            serializer);
+          serializer.writeInt(partition.id());
+        } else {
+          encodeObject(obj, precision, serializer);
+        }
+      }
+    } catch (Exception e) {
+      LOG.error("Fail to encode the objects.", e);
+      byteArray.release();
+      return null;
+    }
+    return new ByteArray(byteArray.get(),
+      byteArray.start(),
+      serializer.getPos() - byteArray.start());
+  }
+
+  /**
+   * Encode an object with the best encoding
+   */
+  private static void encodeObject(
+    Transferable obj, byte precision,
+    Serializer out) throws IOException {
+    if (obj instanceof DoubleArray) {
+      encodeDoubles((DoubleArray) obj, precision,
+        out);
+    } else if (obj instanceof FloatArray) {
+      encodeFloats((FloatArray) obj, precision,
+        out);
+    } else if (obj instanceof IntArray) {
+      encodeInts((IntArray) obj, out);
+    } else if (obj instanceof LongArray) {
+      encodeLongs((LongArray) obj, out);
+    } else {
+      encodeBytes(obj, out);
+    }
+  }
+
+  /**
+   * Check if the encoded size saves at least one
+   * eighth of the dense size
+   */
+  private static boolean isSmaller(long size,
+    long denseSize) {
+    return size <= denseSize - (denseSize >> 3);
+  }
+
+  private static void writeDense(Transferable obj,
+    Serializer out) throws IOException {
+    out.writeByte(DENSE);
+    obj.encode(out);
+  }
+
+  private static void writeHead(int codec,
+    byte dataType, int size, Serializer out)
+    throws IOException {
+    out.writeByte(codec);
+    out.writeByte(dataType);
+    out.writeInt(size);
+  }
+
+  private static void encodeDoubles(
+    DoubleArray array, byte precision,
+    Serializer out) throws IOException {
+    double[] doubles = array.get();
+    int start = array.start();
+    int size = array.size();
+    if (size == 0 || (size < MIN_ELEMENTS
+      && precision == FULL)) {
+      writeDense(array, out);
+      return;
+    }
+    int end = start + size;
+    int nnz = 0;
+    long gapBytes = 0L;
+    int last = -1;
+    boolean isHalf = true;
+    for (int i = start; i < end; i++) {
+      if (Double
+        .doubleToRawLongBits(doubles[i]) != 0L) {
+        nnz++;
+        gapBytes += getVarIntSize(i - start - last - 1);
+        last = i - start;
+        if (!(Math.abs(doubles[i]) <= MAX_FLOAT16)) {
+          isHalf = false;
+        }
+      }
+    }
+    if (precision == FLOAT16 && !isHalf) {
+      precision = BFLOAT16;
+    }
+    int width = precision == FULL ? 8 : 2;
+    long denseSize = (long) size * width;
+    long sparseSize =
+      4L + gapBytes + (long) nnz * width;
+    if (precision == FULL
+      && !isSmaller(sparseSize, denseSize)) {
+      writeDense(array, out);
+    } else if (precision == FULL
+      || isSmaller(sparseSize, denseSize)) {
+      writeHead(SPARSE | precision,
+        DataType.DOUBLE_ARRAY, size, out);
+      out.writeInt(nnz);
+      last = -1;
+      for (int i = start; i < end; i++) {
+        if (Double
+          .doubleToRawLongBits(doubles[i]) != 0L) {
+          writeVarInt(i - start - last - 1, out);
+          last = i - start;
+          writeDouble(doubles[i], precision, out);
+        }
+      }
+    } else {
+      writeHead(DENSE | precision,
+        DataType.DOUBLE_ARRAY, size, out);
+      for (int i = start; i < end; i++) {
+        writeDouble(doubles[i], precision, out);
+      }
+    }
+  }
+
+  private static void encodeFloats(
+    FloatArray array, byte precision,
+    Serializer out) throws IOException {
+    float[] floats = array.get();
+    int start = array.start();
+    int size = array.size();
+    if (size == 0 || (size < MIN_ELEMENTS
+      && precision == FULL)) {
+      writeDense(array, out);
+      return;
+    }
+    int end = start + size;
+    int nnz = 0;
+    long gapBytes = 0L;
+    int last = -1;
+    boolean isHalf = true;
+    for (int i = start; i < end; i++) {
+      if (Float
+        .floatToRawIntBits(floats[i]) != 0) {
+        nnz++;
+        gapBytes += getVarIntSize(i - start - last - 1);
+        last = i - start;
+        if (!(Math.abs(floats[i]) <= MAX_FLOAT16)) {
+          isHalf = false;
+        }
+      }
+    }
+    if (precision == FLOAT16 && !isHalf) {
+      precision = BFLOAT16;
+    }
+    int width = precision == FULL ? 4 : 2;
+    long denseSize = (long) size * width;
+    long sparseSize =
+      4L + gapBytes + (long) nnz * width;
+    if (precision == FULL
+      && !isSmaller(sparseSize, denseSize)) {
+      writeDense(array, out);
+    } else if (precision == FULL
+      || isSmaller(sparseSize, denseSize)) {
+      writeHead(SPARSE | precision,
+        DataType.FLOAT_ARRAY, size, out);
+      out.writeInt(nnz);
+      last = -1;
+      for (int i = start; i < end; i++) {
+        if (Float
+          .floatToRawIntBits(floats[i]) != 0) {
+          writeVarInt(i - start - last - 1, out);
+          last = i - start;
+          writeFloat(floats[i], precision, out);
+        }
+      }
+    } else {
+      writeHead(DENSE | precision,
+        DataType.FLOAT_ARRAY, size, out);
+      for (int i = start; i < end; i++) {
+        writeFloat(floats[i], precision, out);
+      }
+    }
+  }
+
+  private static void encodeInts(IntArray array,
+    Serializer out) throws IOException {
+    int[] ints = array.get();
+    int start = array.start();
+    int size = array.size();
+    if (size < MIN_ELEMENTS) {
+      writeDense(array, out);
+      return;
+    }
+    int end = start + size;
+    int nnz = 0;
+    long sparseSize = 4L;
+    long deltaSize = 0L;
+    int last = -1;
+    int prev = 0;
+    for (int i = start; i < end; i++) {
+      int v = ints[i];
+      if (v != 0) {
+        nnz++;
+        sparseSize += getVarIntSize(i - start - last - 1)
+          + getVarIntSize(zigzag(v));
+        last = i - start;
+      }
+      deltaSize += getVarIntSize(zigzag(v - prev));
+      prev = v;
+    }
+    long denseSize = (long) size * 4;
+    if (sparseSize <= deltaSize
+      && isSmaller(sparseSize, denseSize)) {
+      writeHead(SPARSE, DataType.INT_ARRAY, size,
+        out);
+      out.writeInt(nnz);
+      last = -1;
+      for (int i = start; i < end; i++) {
+        if (ints[i] != 0) {
+          writeVarInt(i - start - last - 1, out);
+          last = i - start;
+          writeVarInt(zigzag(ints[i]), out);
+        }
+      }
+    } else if (isSmaller(deltaSize, denseSize)) {
+      writeHead(DELTA_VARINT, DataType.INT_ARRAY,
+        size, out);
+      prev = 0;
+      for (int i = start; i < end; i++) {
+        writeVarInt(zigzag(ints[i] - prev), out);
+        prev = ints[i];
+      }
+    } else {
+      writeDense(array, out);
+    }
+  }
+
+  private static void encodeLongs(
+    LongArray array, Serializer out)
+    throws IOException {
+    long[] longs = array.get();
+    int start = array.start();
+    int size = array.size();
+    if (size < MIN_ELEMENTS) {
+      writeDense(array, out);
+      return;
+    }
+    int end = start + size;
+    int nnz = 0;
+    long sparseSize = 4L;
+    long deltaSize = 0L;
+    int last = -1;
+    long prev = 0L;
+    for (int i = start; i < end; i++) {
+      long v = longs[i];
+      if (v != 0L) {
+        nnz++;
+        sparseSize += getVarIntSize(i - start - last - 1)
+          + getVarLongSize(zigzag(v));
+        last = i - start;
+      }
+      deltaSize += getVarLongSize(zigzag(v - prev));
+      prev = v;
+    }
+    long denseSize = (long) size * 8;
+    if (sparseSize <= deltaSize
+      && isSmaller(sparseSize, denseSize)) {
+      writeHead(SPARSE, DataType.LONG_ARRAY, size,
+        out);
+      out.writeInt(nnz);
+      last = -1;
+      for (int i = start; i < end; i++) {
+        if (longs[i] != 0L) {
+          writeVarInt(i - start - last - 1, out);
+          last = i - start;
+          writeVarLong(zigzag(longs[i]), out);
+        }
+      }
+    } else if (isSmaller(deltaSize, denseSize)) {
+      writeHead(DELTA_VARINT, DataType.LONG_ARRAY,
+        size, out);
+      prev = 0L;
+      for (int i = start; i < end; i++) {
+        writeVarLong(zigzag(longs[i] - prev), out);
+        prev = longs[i];
+      }
+    } else {
+      writeDense(array, out);
+    }
+  }
+
+  /**
+   * Compress the normal encoding of the object if
+   * it is large enough and the compression saves
+   * enough bytes
+   */
+  private static void encodeBytes(
+    Transferable obj, Serializer out)
+    throws IOException {
+    int maxRawSize = obj.getNumEnocdeBytes();
+    if (maxRawSize < MIN_LZ_BYTES) {
+      writeDense(obj, out);
+      return;
+    }
+    ByteArray raw = ByteArray.create(maxRawSize, true);
+    ByteArray compressed =
+      ByteArray.create(maxRawSize, true);
+    try {
+      if (raw != null && compressed != null) {
+        Serializer rawOut = new Serializer(raw);
+        obj.encode(rawOut);
+        int rawSize = rawOut.getPos();
+        // Codec, raw size and compressed size
+        int maxSize =
+          rawSize - (rawSize >> 3) - 9;
+        int size = LZCodec.compress(raw.get(), 0,
+          rawSize, compressed.get(), 0, maxSize);
+        if (size > 0) {
+          out.writeByte(LZ);
+          out.writeInt(rawSize);
+          out.writeInt(size);
+          out.write(compressed.get(), 0, size);
+          return;
+        }
+      }
+    } finally {
+      if (raw != null) {
+        raw.release();
+      }
+      if (compressed != null) {
+        compressed.release();
+      }
+    }
+    writeDense(obj, out);
+  }
+
+  /**
+   * Decode an object which is not dense. The
+   * arrays are taken from the resource pool.
+   * 
+   * @param codec
+   *          the codec of the object
+   * @param din
+   *          the Deserializer
+   * @return the object, null if failed
+   */
+  public static Simple decode(byte codec,
+    Deserializer din) {
+    int layout = codec & LAYOUT_MASK;
+    byte precision = (byte) (codec & PRECISION_MASK);
+    try {
+      if (layout == LZ) {
+        return decodeLZ(din);
+      }
+      byte dataType = din.readByte();
+      int size = din.readInt();
+      if (dataType == DataType.DOUBLE_ARRAY) {
+        return decodeDoubles(layout, precision,
+          size, din);
+      } else if (dataType == DataType.FLOAT_ARRAY) {
+        return decodeFloats(layout, precision,
+          size, din);
+      } else if (dataType == DataType.INT_ARRAY) {
+        return decodeInts(layout, size, din);
+      } else if (dataType == DataType.LONG_ARRAY) {
+        return decodeLongs(layout, size, din);
+      } else {
+        LOG.error("Cannot decode data type "
+          + dataType + " with codec " + codec);
+        return null;
+      }
+    } catch (IOException e) {
+      LOG.error(
+        "Fail to decode the object with codec "
+          + codec,
+        e);
+      return null;
+    }
+  }
+
+  private static Simple decodeLZ(Deserializer din)
+    throws IOException {
+    int rawSize = din.readInt();
+    int size = din.readInt();
+    ByteArray raw = ByteArray.create(rawSize, true);
+    ByteArray compressed =
+      ByteArray.create(size, true);
+    try {
+      if (raw == null || compressed == null) {
+        throw new IOException(
+          "Fail to get the arrays.");
+      }
+      din.readFully(compressed.get(), 0, size);
+      LZCodec.decompress(compressed.get(), 0, size,
+        raw.get(), 0, rawSize);
+      Deserializer rawIn =
+        new Deserializer(raw.get(), 0, rawSize);
+      return DataUtil.deserializeSimple(
+        rawIn.readByte(), rawIn);
+    } finally {
+      if (raw != null) {
+        raw.release();
+      }
+      if (compressed != null) {
+        compressed.release();
+      }
+    }
+  }
+
+  private static int readIndex(int last,
+    int size, Deserializer din)
+    throws IOException {
+    int index = last + readVarInt(din) + 1;
+    if (index < 0 || index >= size) {
+      throw new IOException(
+        "Index out of bound: " + index);
+    }
+    return index;
+  }
+
+  private static DoubleArray decodeDoubles(
+    int layout, byte precision, int size,
+    Deserializer din) throws IOException {
+    DoubleArray array =
+      DoubleArray.create(size, false);
+    if (array == null) {
+      throw new IOException(
+        "Fail to get the double array.");
+    }
+    double[] doubles = array.get();
+    try {
+      if (layout == SPARSE) {
+        Arrays.fill(doubles, 0, size, 0.0);
+        int nnz = din.readInt();
+        int last = -1;
+        for (int i = 0; i < nnz; i++) {
+          last = readIndex(last, size, din);
+          doubles[last] = readDouble(precision, din);
+        }
+      } else if (layout == DENSE) {
+        for (int i = 0; i < size; i++) {
+          doubles[i] = readDouble(precision, din);
+        }
+      } else {
+        throw new IOException(
+          "Unknown layout " + layout);
+      }
+    } catch (IOException e) {
+      array.release();
+      throw e;
+    }
+    return array;
+  }
+
+  private static FloatArray decodeFloats(
+    int layout, byte precision, int size,
+    Deserializer din) throws IOException {
+    FloatArray array =
+      FloatArray.create(size, false);
+    if (array == null) {
+      throw new IOException(
+        "Fail to get the float array.");
+    }
+    float[] floats = array.get();
+    try {
+      if (layout == SPARSE) {
+        Arrays.fill(floats, 0, size, 0.0f);
+        int nnz = din.readInt();
+        int last = -1;
+        for (int i = 0; i < nnz; i++) {
+          last = readIndex(last, size, din);
+          floats[last] = readFloat(precision, din);
+        }
+      } else if (layout == DENSE) {
+        for (int i = 0; i < size; i++) {
+          floats[i] = readFloat(precision, din);
+        }
+      } else {
+        throw new IOException(
+          "Unknown layout " + layout);
+      }
+    } catch (IOException e) {
+      array.release();
+      throw e;
+    }
+    return array;
+  }
+
+  private static IntArray decodeInts(int layout,
+    int size, Deserializer din)
+    throws IOException {
+    IntArray array = IntArray.create(size, false);
+    if (array == null) {
+      throw new IOException(
+        "Fail to get the int array.");
+    }
+    int[] ints = array.get();
+    try {
+      if (layout == SPARSE) {
+        Arrays.fill(ints, 0, size, 0);
+        int nnz = din.readInt();
+        int last = -1;
+        for (int i = 0; i < nnz; i++) {
+          last = readIndex(last, size, din);
+          ints[last] = unzigzag(readVarInt(din));
+        }
+      } else if (layout == DELTA_VARINT) {
+        int prev = 0;
+        for (int i = 0; i < size; i++) {
+          prev += unzigzag(readVarInt(din));
+          ints[i] = prev;
+        }
+      } else {
+        throw new IOException(
+          "Unknown layout " + layout);
+      }
+    } catch (IOException e) {
+      array.release();
+      throw e;
+    }
+    return array;
+  }
+
+  private static LongArray decodeLongs(
+    int layout, int size, Deserializer din)
+    throws IOException {
+    LongArray array =
+      LongArray.create(size, false);
+    if (array == null) {
+      throw new IOException(
+        "Fail to get the long array.");
+    }
+    long[] longs = array.get();
+    try {
+      if (layout == SPARSE) {
+        Arrays.fill(longs, 0, size, 0L);
+        int nnz = din.readInt();
+        int last = -1;
+        for (int i = 0; i < nnz; i++) {
+          last = readIndex(last, size, din);
+          longs[last] = unzigzag(readVarLong(din));
+        }
+      } else if (layout == DELTA_VARINT) {
+        long prev = 0L;
+        for (int i = 0; i < size; i++) {
+          prev += unzigzag(readVarLong(din));
+          longs[i] = prev;
+        }
+      } else {
+        throw new IOException(
+          "Unknown layout " + layout);
+      }
+    } catch (IOException e) {
+      array.release();
+      throw e;
+    }
+    return array;
+  }
+
+  private static void writeDouble(double v,
+    byte precision, Serializer out)
+    throws IOException {
+    if (precision == FULL) {
+      out.writeDouble(v);
+    } else {
+      writeFloat((float) v, precision, out);
+    }
+  }
+
+  private static void writeFloat(float v,
+    byte precision, Serializer out)
+    throws IOException {
+    if (precision == FULL) {
+      out.writeFloat(v);
+    } else if (precision == FLOAT16) {
+      out.writeShort(toFloat16(v));
+    } else {
+      out.writeShort(toBFloat16(v));
+    }
+  }
+
+  private static double readDouble(
+    byte precision, Deserializer din)
+    throws IOException {
+    if (precision == FULL) {
+      return din.readDouble();
+    } else {
+      return readFloat(precision, din);
+    }
+  }
+
+  private static float readFloat(byte precision,
+    Deserializer din) throws IOException {
+    if (precision == FULL) {
+      return din.readFloat();
+    } else if (precision == FLOAT16) {
+      return fromFloat16(din.readShort());
+    } else {
+      return fromBFloat16(din.readShort());
+    }
+  }
+
+  /**
+   * Convert a float to float16, rounding to the
+   * nearest even
+   * 
+   * @param f
+   *          the float
+   * @return the bits of the float16
+   */
+  public static short toFloat16(float f) {
+    int bits = Float.floatToRawIntBits(f);
+    int sign = (bits >>> 16) & 0x8000;
+    int val = bits & 0x7FFFFFFF;
+    if (val >= 0x7F800000) {
+      // Infinity or NaN
+      return (short) (sign | 0x7C00
+        | (val > 0x7F800000 ? 0x200 : 0));
+    }
+    if (val >= 0x477FF000) {
+      // Rounds to infinity
+      return (short) (sign | 0x7C00);
+    }
+    if (val < 0x38800000) {
+      // Subnormal or zero
+      if (val < 0x33000000) {
+        return (short) sign;
+      }
+      int shift = 126 - (val >>> 23);
+      int mant = (val & 0x7FFFFF) | 0x800000;
+      int h = mant >>> shift;
+      int rem = mant & ((1 << shift) - 1);
+      int half = 1 << (shift - 1);
+      if (rem > half
+        || (rem == half && (h & 1) != 0)) {
+        h++;
+      }
+      return (short) (sign | h);
+    }
+    int h = (((val >>> 23) - 112) << 10)
+      | ((val & 0x7FFFFF) >>> 13);
+    int rem = val & 0x1FFF;
+    if (rem > 0x1000
+      || (rem == 0x1000 && (h & 1) != 0)) {
+      h++;
+    }
+    return (short) (sign | h);
+  }
+
+  /**
+   * Convert a float16 to float
+   * 
+   * @param h
+   *          the bits of the float16
+   * @return the float
+   */
+  public static float fromFloat16(short h) {
+    int sign = (h & 0x8000) << 16;
+    int exp = (h >>> 10) & 0x1F;
+    int mant = h & 0x3FF;
+    if (exp == 0x1F) {
+      return Float.intBitsToFloat(
+        sign | 0x7F800000 | (mant << 13));
+    }
+    if (exp == 0) {
+      // 2^-24 per unit
+      float f = mant * 5.9604645E-8f;
+      return sign == 0 ? f : -f;
+    }
+    return Float.intBitsToFloat(
+      sign | ((exp + 112) << 23) | (mant << 13));
+  }
+
+  /**
+   * Convert a float to bfloat16, rounding to the
+   * nearest even
+   * 
+   * @param f
+   *          the float
+   * @return the bits of the bfloat16
+   */
+  public static short toBFloat16(float f) {
+    int bits = Float.floatToRawIntBits(f);
+    if ((bits & 0x7FFFFFFF) > 0x7F800000) {
+      return (short) ((bits >>> 16) | 0x40);
+    }
+    bits += 0x7FFF + ((bits >>> 16) & 1);
+    return (short) (bits >>> 16);
+  }
+
+  /**
+   * Convert a bfloat16 to float
+   * 
+   * @param b
+   *          the bits of the bfloat16
+   * @return the float
+   */
+  public static float fromBFloat16(short b) {
+    return Float.intBitsToFloat((b & 0xFFFF) << 16);
+  }
+
+  private static int zigzag(int v) {
+    return (v << 1) ^ (v >> 31);
+  }
+
+  private static long zigzag(long v) {
+    return (v << 1) ^ (v >> 63);
+  }
+
+  private static int unzigzag(int v) {
+    return (v >>> 1) ^ -(v & 1);
+  }
+
+  private static long unzigzag(long v) {
+    return (v >>> 1) ^ -(v & 1L);
+  }
+
+  private static int getVarIntSize(int v) {
+    int size = 1;
+    while ((v & ~0x7F) != 0) {
+      v >>>= 7;
+      size++;
+    }
+    return size;
+  }
+
+  private static int getVarLongSize(long v) {
+    int size = 1;
+    while ((v & ~0x7FL) != 0L) {
+      v >>>= 7;
+      size++;
+    }
+    return size;
+  }
+
+  private static void writeVarInt(int v,
+    Serializer out) throws IOException {
+    while ((v & ~0x7F) != 0) {
+      out.writeByte((v & 0x7F) | 0x80);
+      v >>>= 7;
+    }
+    out.writeByte(v);
+  }
+
+  private static void writeVarLong(long v,
+    Serializer out) throws IOException {
+    while ((v & ~0x7FL) != 0L) {
+      out.writeByte(((int) v & 0x7F) | 0x80);
+      v >>>= 7;
+    }
+    out.writeByte((int) v);
+  }
+
+  private static int readVarInt(Deserializer din)
+    throws IOException {
+    int v = 0;
+    for (int shift = 0; shift < 35; shift += 7) {
+      int b = din.readByte();
+      v |= (b & 0x7F) << shift;
+      if ((b & 0x80) == 0) {
+        return v;
+      }
+    }
+    throw new IOException("Malformed varint.");
+  }
+
+  private static long readVarLong(
+    Deserializer din) throws IOException {
+    long v = 0L;
+    for (int shift = 0; shift < 70; shift += 7) {
+      int b = din.readByte();
+      v |= (long) (b & 0x7F) << shift;
+      if ((b & 0x80) == 0) {
+        return v;
+      }
+    }
+    throw new IOException("Malformed varint.");
+  }
+}
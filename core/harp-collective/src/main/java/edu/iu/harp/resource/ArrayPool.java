@@ -17,45 +17,124 @@
 package edu.iu.harp.resource;
 
 import edu.iu.harp.io.Constant;
-import it.unimi.dsi.fastutil.ints.Int2ObjectMap;
 import it.unimi.dsi.fastutil.ints.Int2ObjectOpenHashMap;
-import it.unimi.dsi.fastutil.objects.ObjectIterator;
 import org.apache.log4j.Logger;
 
-import java.util.HashSet;
-import java.util.LinkedList;
+import java.util.Map;
+import java.util.Set;
+import java.util.concurrent.ConcurrentHashMap;
+import java.util.concurrent.ConcurrentLinkedDeque;
+import java.util.concurrent.atomic.AtomicInteger;
+import java.util.concurrent.atomic.AtomicLong;
+import java.util.concurrent.atomic.AtomicReferenceArray;
+import java.util.concurrent.atomic.LongAdder;
 
 /*******************************************************
  * The abstract class of pools. An ArrayPool is
  * used for caching arrays. The arrays, which were
  * allocated before and are no longer used, will
  * be cached for reuse.
+ * 
+ * Arrays are grouped by size. Each thread keeps
+ * a small magazine of free arrays per size, so
+ * most get/release calls do not touch the shared
+ * free stacks. Magazines are refilled from and
+ * flushed to a lock-free stack per size. The
+ * in-use arrays of a size are still tracked in
+ * one concurrent set shared by all threads, so
+ * that arrays not allocated by the pool or
+ * released twice are rejected; every get and
+ * release updates this set. The bytes held in
+ * the shared stacks are capped; when the cap is
+ * exceeded, the least recently released arrays
+ * are dropped.
  ******************************************************/
 public abstract class ArrayPool<T> {
 
   private static final Logger LOG =
     Logger.getLogger(ArrayPool.class);
-  /* A map from size to ArrayStore */
-  private Int2ObjectOpenHashMap<ArrayStore> arrayMap;
+
+  /** The number of arrays in a magazine */
+  private static final int MAGAZINE_SIZE = 8;
+  /**
+   * Arrays larger than this are not cached in
+   * magazines, so that idle threads don't hold
+   * large buffers
+   */
+  private static final long MAGAZINE_MAX_ARRAY_BYTES =
+    Constant.PIPELINE_SIZE * 4L;
+
+  /** The number of bytes per element */
+  private final int elementBytes;
+  /** Stores of power-of-2 sizes */
+  private final AtomicReferenceArray<ArrayStore> pow2Stores;
+  /** Stores of the other sizes */
+  private final ConcurrentHashMap<Integer, ArrayStore> arrayMap;
+  /** Per-thread magazines, keyed by size */
+  private final ThreadLocal<Int2ObjectOpenHashMap<Magazine>> magazines;
+  /**
+   * Bumped by clean(), magazines of an older
+   * epoch are emptied by their threads
+   */
+  private final AtomicInteger epoch;
+
+  private volatile long maxHeldBytes;
+  private final AtomicLong numHeldBytes;
+  private final LongAdder numHits;
+  private final LongAdder numMisses;
 
   /**
    * ArrayStore is used for buffering Arrays.
-   * freeQueue stores not-in-use Arrays, which can
+   * freeStack stores not-in-use Arrays, which can
    * be used as required to avoid reallocating
    * Arrays. inUseSet stores in-use arrays.
    */
   private class ArrayStore {
-    private LinkedList<T> freeQueue;
-    private HashSet<T> inUseSet;
+    private final int size;
+    private final ConcurrentLinkedDeque<T> freeStack;
+    private final Set<T> inUseSet;
 
-    private ArrayStore() {
-      freeQueue = new LinkedList<>();
-      inUseSet = new HashSet<>();
+    private ArrayStore(int size) {
+      this.size = size;
+      freeStack = new ConcurrentLinkedDeque<>();
+      inUseSet = ConcurrentHashMap.newKeySet();
     }
   }
 
-  public ArrayPool() {
-    arrayMap = new Int2ObjectOpenHashMap<>();
+  /**
+   * Magazine caches free arrays of one size for
+   * one thread. Only the owner thread accesses
+   * it.
+   */
+  private class Magazine {
+    private final Object[] arrays;
+    private int count;
+    private int epoch;
+
+    private Magazine(int epoch) {
+      arrays = new Object[MAGAZINE_SIZE];
+      count = 0;
+      this.epoch = epoch;
+    }
+  }
+
+  /**
+   * Constructor.
+   * 
+   * @param elementBytes
+   *          the number of bytes per element
+   */
+  public ArrayPool(int elementBytes) {
+    this.elementBytes = elementBytes;
+    pow2Stores = new AtomicReferenceArray<>(32);
+    arrayMap = new ConcurrentHashMap<>();
+    magazines = ThreadLocal
+      .withInitial(Int2ObjectOpenHashMap::new);
+    epoch = new AtomicInteger(0);
+    maxHeldBytes = Long.MAX_VALUE;
+    numHeldBytes = new AtomicLong(0L);
+    numHits = new LongAdder();
+    numMisses = new LongAdder();
   }
 
   /**
@@ -99,6 +178,115 @@ public abstract class ArrayPool<T> {
    */
   protected abstract int getLength(T array);
 
+  /**
+   * Get the store of the size
+   * 
+   * @param size
+   *          the array size
+   * @param create
+   *          if creating the store when it
+   *          doesn't exist
+   * @return the store, null if not existing
+   */
+  private ArrayStore getArrayStore(int size,
+    boolean create) {
+    if (Integer.bitCount(size) == 1) {
+      int index =
+        Integer.numberOfTrailingZeros(size);
+      ArrayStore store = pow2Stores.get(index);
+      if (store == null && create) {
+        pow2Stores.compareAndSet(index, null,
+          new ArrayStore(size));
+        store = pow2Stores.get(index);
+      }
+      return store;
+    } else if (create) {
+      return arrayMap.computeIfAbsent(size,
+        ArrayStore::new);
+    } else {
+      return arrayMap.get(size);
+    }
+  }
+
+  /**
+   * Get the magazine of the size for the current
+   * thread. Magazines are only used for small
+   * arrays.
+   * 
+   * @param size
+   *          the array size
+   * @return the magazine, null if arrays of this
+   *         size are not cached in magazines
+   */
+  private Magazine getMagazine(int size) {
+    if ((long) size
+      * elementBytes > MAGAZINE_MAX_ARRAY_BYTES) {
+      return null;
+    }
+    Int2ObjectOpenHashMap<Magazine> map =
+      magazines.get();
+    Magazine magazine = map.get(size);
+    int curEpoch = epoch.get();
+    if (magazine == null) {
+      magazine = new Magazine(curEpoch);
+      map.put(size, magazine);
+    } else if (magazine.epoch != curEpoch) {
+      // The pool was cleaned
+      for (int i = 0; i < magazine.count; i++) {
+        magazine.arrays[i] = null;
+      }
+      magazine.count = 0;
+      magazine.epoch = curEpoch;
+    }
+    return magazine;
+  }
+
+  /**
+   * Get the number of bytes of arrays of the size
+   * 
+   * @param size
+   *          the array size
+   * @return the number of bytes
+   */
+  private long getNumBytes(int size) {
+    return (long) size * elementBytes;
+  }
+
+  /**
+   * Pop a free array from the shared stack
+   * 
+   * @param store
+   *          the ArrayStore
+   * @return a free array, null if the stack is
+   *         empty
+   */
+  private T popFreeArray(ArrayStore store) {
+    T array = store.freeStack.pollFirst();
+    if (array != null) {
+      numHeldBytes
+        .addAndGet(-getNumBytes(store.size));
+    }
+    return array;
+  }
+
+  /**
+   * Push a free array to the shared stack. Trim
+   * the idle arrays if the cap is exceeded.
+   * 
+   * @param store
+   *          the ArrayStore
+   * @param array
+   *          the free array
+   */
+  private void pushFreeArray(ArrayStore store,
+    T array) {
+    store.freeStack.offerFirst(array);
+    if (numHeldBytes.addAndGet(getNumBytes(
+      store.size)) > maxHeldBytes) {
+      trim(maxHeldBytes);
+    }
+  }
+
   /**
    * If approximate is false, get an array of
    * required size. else, get an array of adjusted
@@ -110,8 +298,8 @@ public abstract class ArrayPool<T> {
    * @param approximate
    * @return an array
    */
-  synchronized T getArray(int size,
-    boolean approximate) {
+  @SuppressWarnings("unchecked")
+  T getArray(int size, boolean approximate) {
     int originSize = size;
     if (originSize <= 0) {
       return null;
@@ -122,24 +310,33 @@ public abstract class ArrayPool<T> {
       return null;
     }
     ArrayStore arrayStore =
-      arrayMap.get(adjustSize);
-    if (arrayStore == null) {
-      arrayStore = new ArrayStore();
-      arrayMap.put(adjustSize, arrayStore);
+      getArrayStore(adjustSize, true);
+    T array = null;
+    Magazine magazine = getMagazine(adjustSize);
+    if (magazine != null) {
+      if (magazine.count == 0) {
+        // Refill half of the magazine
+        for (int i = 0; i < MAGAZINE_SIZE / 2; i++) {
+          T freeArray = popFreeArray(arrayStore);
+          if (freeArray == null) {
+            break;
+          }
+          magazine.arrays[magazine.count++] =
+            freeArray;
+        }
+      }
+      if (magazine.count > 0) {
+        array =
+          (T) magazine.arrays[--magazine.count];
+        magazine.arrays[magazine.count] = null;
+      }
+    } else {
+      array = popFreeArray(arrayStore);
     }
-    if (arrayStore.freeQueue.isEmpty()) {
+    if (array == null) {
+      numMisses.increment();
       try {
-        T array = createNewArray(adjustSize);
-        arrayStore.inUseSet.add(array);
-        // LOG
-        // .info("Create a new array with original
-        // size: "
-        // + originSize
-        // + ", adjusted size: "
-        // + adjustSize
-        // + ", with type: "
-        // + array.getClass().getName());
-        return array;
+        array = createNewArray(adjustSize);
       } catch (Throwable t) {
         LOG.error(
           "Cannot create array with size "
@@ -152,58 +349,50 @@ public abstract class ArrayPool<T> {
         return null;
       }
     } else {
-      T array =
-        arrayStore.freeQueue.removeFirst();
-      arrayStore.inUseSet.add(array);
-      // LOG
-      // .info("Get an existing array with
-      // adjusted size: "
-      // + adjustSize
-      // + ", with type "
-      // + array.getClass().getName());
-      return array;
+      numHits.increment();
     }
+    arrayStore.inUseSet.add(array);
+    return array;
   }
 
   /**
    * Release the array by moving the array from
-   * inUseSet to freeQueue. The array can be used
-   * as a new array later.
+   * inUseSet to the magazine of this thread or
+   * the shared stack. The array can be used as a
+   * new array later.
    * 
    * @param array
    *          the array to release
    * @return true if succeeded, false if failed.
    */
-  synchronized boolean releaseArray(T array) {
+  boolean releaseArray(T array) {
     if (array == null) {
       return false;
     }
     int size = getLength(array);
-    ArrayStore arrayStore = arrayMap.get(size);
-    if (arrayStore == null) {
-      // LOG
-      // .info("Fail to release an array with
-      // size: "
-      // + size
-      // + ", with type "
-      // + array.getClass().getName()
-      // + ". no such store.");
+    ArrayStore arrayStore =
+      getArrayStore(size, false);
+    if (arrayStore == null
+      || !arrayStore.inUseSet.remove(array)) {
       return false;
-    } else {
-      if (arrayStore.inUseSet.remove(array)) {
-        arrayStore.freeQueue.add(array);
-        return true;
-      } else {
-        // LOG
-        // .info("Fail to release an array with
-        // size: "
-        // + size
-        // + ", with type "
-        // + array.getClass().getName()
-        // + ". no such an array.");
-        return false;
+    }
+    Magazine magazine = getMagazine(size);
+    if (magazine != null) {
+      if (magazine.count == MAGAZINE_SIZE) {
+        // Flush half of the magazine
+        for (int i = 0; i < MAGAZINE_SIZE / 2; i++) {
+          @SuppressWarnings("unchecked")
+          T freeArray =
+            (T) magazine.arrays[--magazine.count];
+          magazine.arrays[magazine.count] = null;
+          pushFreeArray(arrayStore, freeArray);
+        }
       }
+      magazine.arrays[magazine.count++] = array;
+    } else {
+      pushFreeArray(arrayStore, array);
     }
+    return true;
   }
 
   /**
@@ -214,12 +403,10 @@ public abstract class ArrayPool<T> {
    *          the array to be freed
    * @return true if succeeded, false if failed
    */
-  synchronized boolean freeArray(T array) {
+  boolean freeArray(T array) {
     int size = getLength(array);
-    // LOG.info("Free an array with size: " + size
-    // + ", with type "
-    // + array.getClass().getName());
-    ArrayStore arrayStore = arrayMap.get(size);
+    ArrayStore arrayStore =
+      getArrayStore(size, false);
     if (arrayStore == null) {
       return false;
     } else {
@@ -228,30 +415,131 @@ public abstract class ArrayPool<T> {
   }
 
   /**
-   * Clean all arrays in freeQueue, namely remove
-   * all not-in-use arrays.
+   * Drop the least recently released arrays in
+   * the shared stacks until the held bytes are
+   * no more than the target. Larger arrays are
+   * dropped first.
+   * 
+   * @param targetBytes
+   *          the number of bytes to keep
    */
-  synchronized void clean() {
+  void trim(long targetBytes) {
+    for (int i = pow2Stores.length() - 1; i >= 0
+      && numHeldBytes.get() > targetBytes; i--) {
+      ArrayStore store = pow2Stores.get(i);
+      if (store != null) {
+        trimStore(store, targetBytes);
+      }
+    }
     for (ArrayStore store : arrayMap.values()) {
-      store.freeQueue.clear();
+      if (numHeldBytes.get() <= targetBytes) {
+        break;
+      }
+      trimStore(store, targetBytes);
     }
   }
 
+  /**
+   * Drop the idle arrays of a store until the
+   * held bytes are no more than the target.
+   * 
+   * @param store
+   *          the ArrayStore
+   * @param targetBytes
+   *          the number of bytes to keep
+   */
+  private void trimStore(ArrayStore store,
+    long targetBytes) {
+    while (numHeldBytes.get() > targetBytes
+      && store.freeStack.pollLast() != null) {
+      numHeldBytes
+        .addAndGet(-getNumBytes(store.size));
+    }
+  }
+
+  /**
+   * Clean all arrays in the shared stacks and the
+   * magazines, namely remove all not-in-use
+   * arrays. Magazines of other threads are
+   * emptied when the threads use them next time.
+   */
+  void clean() {
+    epoch.incrementAndGet();
+    trim(0L);
+  }
+
+  /**
+   * Set the maximum number of bytes held by the
+   * free arrays in the shared stacks. Arrays in
+   * magazines are not counted, they are bounded
+   * by the magazine size.
+   * 
+   * @param maxBytes
+   *          the cap in bytes
+   */
+  void setMaxHeldBytes(long maxBytes) {
+    maxHeldBytes = maxBytes;
+    trim(maxBytes);
+  }
+
+  /**
+   * Get the number of bytes held by the free
+   * arrays in the shared stacks
+   * 
+   * @return the number of bytes
+   */
+  public long getNumHeldBytes() {
+    return numHeldBytes.get();
+  }
+
+  /**
+   * Get the number of requests served by cached
+   * arrays
+   * 
+   * @return the number of hits
+   */
+  public long getNumHits() {
+    return numHits.sum();
+  }
+
+  /**
+   * Get the number of requests served by new
+   * arrays
+   * 
+   * @return the number of misses
+   */
+  public long getNumMisses() {
+    return numMisses.sum();
+  }
+
   /**
    * Logging the usage of the arrays.
    */
-  synchronized void log() {
-    ObjectIterator<Int2ObjectMap.Entry<ArrayStore>> iterator =
-      arrayMap.int2ObjectEntrySet()
-        .fastIterator();
-    while (iterator.hasNext()) {
-      Int2ObjectMap.Entry<ArrayStore> entry =
-        iterator.next();
-      LOG.info(this + ": size="
-        + entry.getIntKey() + ", use="
-        + entry.getValue().inUseSet.size()
-        + ", released="
-        + entry.getValue().freeQueue.size());
+  void log() {
+    for (int i = 0; i < pow2Stores.length(); i++) {
+      ArrayStore store = pow2Stores.get(i);
+      if (store != null) {
+        logStore(store);
+      }
     }
+    for (Map.Entry<Integer, ArrayStore> entry : arrayMap
+      .entrySet()) {
+      logStore(entry.getValue());
+    }
+    LOG.info(this + ": hits=" + getNumHits()
+      + ", misses=" + getNumMisses()
+      + ", held bytes=" + getNumHeldBytes());
+  }
+
+  /**
+   * Logging the usage of the arrays in a store.
+   * 
+   * @param store
+   *          the ArrayStore
+   */
+  private void logStore(ArrayStore store) {
+    LOG.info(this + ": size=" + store.size
+      + ", use=" + store.inUseSet.size()
+      + ", released=" + store.freeStack.size());
   }
 }
@@ -22,7 +22,7 @@ package edu.iu.harp.resource;
 public class BytesPool extends ArrayPool<byte[]> {
 
   public BytesPool() {
-    super();
+    super(Byte.BYTES);
   }
 
   /**
@@ -23,7 +23,7 @@ public class DoublesPool
   extends ArrayPool<double[]> {
 
   public DoublesPool() {
-    super();
+    super(Double.BYTES);
   }
 
   /**
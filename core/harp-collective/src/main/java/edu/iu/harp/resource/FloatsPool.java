@@ -23,7 +23,7 @@ public class FloatsPool
   extends ArrayPool<float[]> {
 
   public FloatsPool() {
-    super();
+    super(Float.BYTES);
   }
 
   /**
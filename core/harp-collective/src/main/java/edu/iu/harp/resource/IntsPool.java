@@ -22,7 +22,7 @@ package edu.iu.harp.resource;
 public class IntsPool extends ArrayPool<int[]> {
 
   public IntsPool() {
-    super();
+    super(Integer.BYTES);
   }
 
   /**
@@ -22,7 +22,7 @@ package edu.iu.harp.resource;
 public class LongsPool extends ArrayPool<long[]> {
 
   public LongsPool() {
-    super();
+    super(Long.BYTES);
   }
 
   /**
@@ -92,6 +92,68 @@ public class ResourcePool {
     writables.clean();
   }
 
+  /**
+   * Set the maximum number of bytes held by the
+   * free arrays in each array pool. Idle arrays
+   * beyond the cap are dropped.
+   * 
+   * @param maxBytes
+   *          the cap in bytes
+   */
+  public void setMaxHeldBytes(long maxBytes) {
+    byteArrays.setMaxHeldBytes(maxBytes);
+    shortArrays.setMaxHeldBytes(maxBytes);
+    intArrays.setMaxHeldBytes(maxBytes);
+    floatArrays.setMaxHeldBytes(maxBytes);
+    longArrays.setMaxHeldBytes(maxBytes);
+    doubleArrays.setMaxHeldBytes(maxBytes);
+  }
+
+  /**
+   * Get the number of array requests served by
+   * cached arrays in all the array pools
+   * 
+   * @return the number of hits
+   */
+  public long getNumArrayHits() {
+    return byteArrays.getNumHits()
+      + shortArrays.getNumHits()
+      + intArrays.getNumHits()
+      + floatArrays.getNumHits()
+      + longArrays.getNumHits()
+      + doubleArrays.getNumHits();
+  }
+
+  /**
+   * Get the number of array requests served by
+   * new arrays in all the array pools
+   * 
+   * @return the number of misses
+   */
+  public long getNumArrayMisses() {
+    return byteArrays.getNumMisses()
+      + shortArrays.getNumMisses()
+      + intArrays.getNumMisses()
+      + floatArrays.getNumMisses()
+      + longArrays.getNumMisses()
+      + doubleArrays.getNumMisses();
+  }
+
+  /**
+   * Get the number of bytes held by the free
+   * arrays in all the array pools
+   * 
+   * @return the number of bytes
+   */
+  public long getNumHeldBytes() {
+    return byteArrays.getNumHeldBytes()
+      + shortArrays.getNumHeldBytes()
+      + intArrays.getNumHeldBytes()
+      + floatArrays.getNumHeldBytes()
+      + longArrays.getNumHeldBytes()
+      + doubleArrays.getNumHeldBytes();
+  }
+
   public void log() {
     byteArrays.log();
     shortArrays.log();
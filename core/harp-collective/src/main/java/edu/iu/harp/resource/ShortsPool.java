@@ -23,7 +23,7 @@ public class ShortsPool
   extends ArrayPool<short[]> {
 
   public ShortsPool() {
-    super();
+    super(Short.BYTES);
   }
 
   /**
@@ -26,9 +26,17 @@ import java.util.concurrent.BlockingQueue;
 import java.util.concurrent.LinkedBlockingDeque;
 import java.util.concurrent.LinkedBlockingQueue;
 import java.util.concurrent.Semaphore;
+import java.util.function.ToIntFunction;
 
 /*******************************************************
- * The dynamic scheduler
+ * The dynamic scheduler. By default all the
+ * inputs go through one shared queue. In the
+ * work-stealing mode, each task monitor owns a
+ * deque and steals from the others when its own
+ * deque is empty. An optional affinity function
+ * maps inputs to task monitors, so that inputs
+ * on the same model partition are run by the
+ * same thread unless it falls behind.
  ******************************************************/
 public class DynamicScheduler<I, O, T extends Task<I, O>> {
 
@@ -36,7 +44,10 @@ public class DynamicScheduler<I, O, T extends Task<I, O>> {
     Logger.getLogger(DynamicScheduler.class);
 
   private final BlockingDeque<Input<I>> inputQueue;
+  private final TaskDeques<I> taskDeques;
   private final BlockingQueue<Output<O>> outputQueue;
+  private ToIntFunction<I> affinity;
+  private int nextDequeID;
 
   private Thread[] threads;
   private int inputCount;
@@ -50,8 +61,30 @@ public class DynamicScheduler<I, O, T extends Task<I, O>> {
   private final Semaphore barrier1;
 
   public DynamicScheduler(List<T> tasks) {
-    inputQueue = new LinkedBlockingDeque<>();
+    this(tasks, false);
+  }
+
+  /**
+   * Create a dynamic scheduler
+   * 
+   * @param tasks
+   *          the list of tasks, one thread each
+   * @param useWorkStealing
+   *          use per-task deques with work
+   *          stealing instead of one shared queue
+   */
+  public DynamicScheduler(List<T> tasks,
+    boolean useWorkStealing) {
+    if (useWorkStealing) {
+      inputQueue = null;
+      taskDeques = new TaskDeques<>(tasks.size());
+    } else {
+      inputQueue = new LinkedBlockingDeque<>();
+      taskDeques = null;
+    }
     outputQueue = new LinkedBlockingQueue<>();
+    affinity = null;
+    nextDequeID = 0;
     threads = null;
     inputCount = 0;
     outputCount = 0;
@@ -62,12 +95,45 @@ public class DynamicScheduler<I, O, T extends Task<I, O>> {
     numTaskMonitors = tasks.size();
     this.tasks = tasks;
     taskMonitors = new ObjectArrayList<>();
+    int i = 0;
     for (T task : tasks) {
-      taskMonitors.add(new TaskMonitor<>(
-        inputQueue, outputQueue, task, barrier1));
+      if (useWorkStealing) {
+        taskMonitors.add(new TaskMonitor<>(i,
+          taskDeques, outputQueue, task,
+          barrier1));
+      } else {
+        taskMonitors.add(new TaskMonitor<>(
+          inputQueue, outputQueue, task,
+          barrier1));
+      }
+      i++;
     }
   }
 
+  /**
+   * Check if the work-stealing mode is used
+   * 
+   * @return true if work stealing is used, false
+   *         otherwise
+   */
+  public boolean isWorkStealing() {
+    return taskDeques != null;
+  }
+
+  /**
+   * Set the function mapping an input to the ID
+   * of its preferred task (modulo the number of
+   * tasks). Only used in the work-stealing mode.
+   * Set to null to distribute inputs evenly.
+   * 
+   * @param affinity
+   *          the affinity function
+   */
+  public synchronized void
+    setAffinity(ToIntFunction<I> affinity) {
+    this.affinity = affinity;
+  }
+
   /**
    * Get the list of tasks
    * 
@@ -85,8 +151,43 @@ public class DynamicScheduler<I, O, T extends Task<I, O>> {
    */
   public synchronized void submit(I input) {
     if (input != null) {
-      inputQueue
-        .add(new Input<I>(input, false, false));
+      if (taskDeques != null) {
+        taskDeques.add(getDequeID(input), input);
+        taskDeques.signal(false);
+      } else {
+        inputQueue
+          .add(new Input<I>(input, false, false));
+      }
+      if (isRunning) {
+        inputCount++;
+      }
+    }
+  }
+
+  /**
+   * Submit the input to the given task. In the
+   * work-stealing mode the input may still be
+   * stolen by another task when this one is
+   * busy. In the shared queue mode the task ID
+   * is ignored.
+   * 
+   * @param taskID
+   *          the ID of the preferred task
+   * @param input
+   *          the input
+   */
+  public synchronized void submit(int taskID,
+    I input) {
+    if (input != null) {
+      if (taskDeques != null) {
+        taskDeques.add(
+          Math.floorMod(taskID, numTaskMonitors),
+          input);
+        taskDeques.signal(false);
+      } else {
+        inputQueue
+          .add(new Input<I>(input, false, false));
+      }
       if (isRunning) {
         inputCount++;
       }
@@ -101,9 +202,26 @@ public class DynamicScheduler<I, O, T extends Task<I, O>> {
    */
   public synchronized void
     submitAll(Collection<I> inputs) {
-    for (I input : inputs) {
-      inputQueue
-        .add(new Input<I>(input, false, false));
+    if (taskDeques != null) {
+      // Without affinity, give each deque a
+      // contiguous block of the inputs
+      int blockSize =
+        getBlockSize(inputs.size());
+      int i = 0;
+      for (I input : inputs) {
+        if (affinity != null) {
+          taskDeques.add(getDequeID(input), input);
+        } else {
+          taskDeques.add(i / blockSize, input);
+        }
+        i++;
+      }
+      taskDeques.signal(true);
+    } else {
+      for (I input : inputs) {
+        inputQueue
+          .add(new Input<I>(input, false, false));
+      }
     }
     if (isRunning) {
       inputCount += inputs.size();
@@ -119,11 +237,28 @@ public class DynamicScheduler<I, O, T extends Task<I, O>> {
   public synchronized void submitAll(I[] inputs) {
     // Submit inputs
     int submitCount = 0;
-    for (int i = 0; i < inputs.length; i++) {
-      if (inputs[i] != null) {
-        inputQueue.add(
-          new Input<I>(inputs[i], false, false));
-        submitCount++;
+    if (taskDeques != null) {
+      int blockSize = getBlockSize(inputs.length);
+      for (int i = 0; i < inputs.length; i++) {
+        if (inputs[i] != null) {
+          if (affinity != null) {
+            taskDeques.add(getDequeID(inputs[i]),
+              inputs[i]);
+          } else {
+            taskDeques.add(i / blockSize,
+              inputs[i]);
+          }
+          submitCount++;
+        }
+      }
+      taskDeques.signal(true);
+    } else {
+      for (int i = 0; i < inputs.length; i++) {
+        if (inputs[i] != null) {
+          inputQueue.add(
+            new Input<I>(inputs[i], false, false));
+          submitCount++;
+        }
       }
     }
     if (isRunning) {
@@ -131,6 +266,58 @@ public class DynamicScheduler<I, O, T extends Task<I, O>> {
     }
   }
 
+  /**
+   * Get the deque ID of an input from the
+   * affinity function, or round-robin if no
+   * affinity is set
+   * 
+   * @param input
+   *          the input
+   * @return the deque ID
+   */
+  private int getDequeID(I input) {
+    if (affinity != null) {
+      return Math.floorMod(
+        affinity.applyAsInt(input),
+        numTaskMonitors);
+    } else {
+      int dequeID = nextDequeID;
+      nextDequeID++;
+      if (nextDequeID == numTaskMonitors) {
+        nextDequeID = 0;
+      }
+      return dequeID;
+    }
+  }
+
+  /**
+   * Get the number of inputs per deque when
+   * distributing a batch of inputs
+   * 
+   * @param numInputs
+   *          the number of inputs
+   * @return the block size
+   */
+  private int getBlockSize(int numInputs) {
+    int blockSize = (numInputs + numTaskMonitors
+      - 1) / numTaskMonitors;
+    return blockSize > 0 ? blockSize : 1;
+  }
+
+  /**
+   * Get the number of inputs waiting in the
+   * queue(s)
+   * 
+   * @return the number of queued inputs
+   */
+  private int getNumQueuedInputs() {
+    if (taskDeques != null) {
+      return taskDeques.size();
+    } else {
+      return inputQueue.size();
+    }
+  }
+
   /**
    * Start scheduling
    */
@@ -138,7 +325,10 @@ public class DynamicScheduler<I, O, T extends Task<I, O>> {
     // Start monitor threads, wait for inputs
     if (!isRunning) {
       isRunning = true;
-      inputCount += inputQueue.size();
+      inputCount += getNumQueuedInputs();
+      if (taskDeques != null) {
+        taskDeques.setState(TaskDeques.RUNNING);
+      }
       if (isPausing) {
         isPausing = false;
         for (TaskMonitor<I, O, T> monitor : taskMonitors) {
@@ -163,13 +353,17 @@ public class DynamicScheduler<I, O, T extends Task<I, O>> {
     if (isRunning && !isPausing) {
       isRunning = false;
       isPausing = true;
-      for (int i = 0; i < numTaskMonitors; i++) {
-        inputQueue.addLast(
-          new Input<I>(null, true, false));
+      if (taskDeques != null) {
+        taskDeques.setState(TaskDeques.PAUSE);
+      } else {
+        for (int i = 0; i < numTaskMonitors; i++) {
+          inputQueue.addLast(
+            new Input<I>(null, true, false));
+        }
       }
       ComputeUtil.acquire(barrier1,
         numTaskMonitors);
-      inputCount -= inputQueue.size();
+      inputCount -= getNumQueuedInputs();
     }
   }
 
@@ -180,13 +374,17 @@ public class DynamicScheduler<I, O, T extends Task<I, O>> {
     if (isRunning && !isPausing) {
       isRunning = false;
       isPausing = true;
-      for (int i = 0; i < numTaskMonitors; i++) {
-        inputQueue.addFirst(
-          new Input<I>(null, true, false));
+      if (taskDeques != null) {
+        taskDeques.setState(TaskDeques.PAUSE_NOW);
+      } else {
+        for (int i = 0; i < numTaskMonitors; i++) {
+          inputQueue.addFirst(
+            new Input<I>(null, true, false));
+        }
       }
       ComputeUtil.acquire(barrier1,
         numTaskMonitors);
-      inputCount -= inputQueue.size();
+      inputCount -= getNumQueuedInputs();
     }
   }
 
@@ -195,7 +393,11 @@ public class DynamicScheduler<I, O, T extends Task<I, O>> {
    */
   public synchronized void cleanInputQueue() {
     if (isPausing || !isRunning) {
-      inputQueue.clear();
+      if (taskDeques != null) {
+        taskDeques.clear();
+      } else {
+        inputQueue.clear();
+      }
     }
   }
 
@@ -210,9 +412,13 @@ public class DynamicScheduler<I, O, T extends Task<I, O>> {
     }
     if (isRunning) {
       isRunning = false;
-      for (int i = 0; i < numTaskMonitors; i++) {
-        inputQueue.addLast(
-          new Input<I>(null, false, true));
+      if (taskDeques != null) {
+        taskDeques.setState(TaskDeques.STOP);
+      } else {
+        for (int i = 0; i < numTaskMonitors; i++) {
+          inputQueue.addLast(
+            new Input<I>(null, false, true));
+        }
       }
       for (int i = 0; i < numTaskMonitors; i++) {
         ComputeUtil.joinThread(threads[i]);
@@ -253,6 +459,46 @@ public class DynamicScheduler<I, O, T extends Task<I, O>> {
     }
   }
 
+  /**
+   * Block until at least one output is available,
+   * then move all the available outputs to the
+   * given collection with one queue operation.
+   * Failed outputs are counted as errors and not
+   * added.
+   * 
+   * @param outputs
+   *          the collection to add the outputs to
+   * @return the number of outputs drained,
+   *         including failed ones; 0 if no output
+   *         is expected
+   */
+  public synchronized int
+    drainOutputs(Collection<O> outputs) {
+    if (!hasNext()) {
+      return 0;
+    }
+    List<Output<O>> batch =
+      new ObjectArrayList<>();
+    outputQueue.drainTo(batch,
+      inputCount - outputCount);
+    while (batch.isEmpty()) {
+      try {
+        batch.add(outputQueue.take());
+      } catch (Exception e) {
+        LOG.error("Error when waiting output", e);
+      }
+    }
+    for (Output<O> output : batch) {
+      if (output.isError()) {
+        errorCount++;
+      } else {
+        outputs.add(output.getOutput());
+      }
+    }
+    outputCount += batch.size();
+    return batch.size();
+  }
+
   /**
    * Check if has a new output
    * 
@@ -0,0 +1,164 @@
+/*
+ * Copyright 2013-2017 Indiana University
+ * 
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+package edu.iu.harp.schdynamic;
+
+import it.unimi.dsi.fastutil.objects.ObjectArrayList;
+
+import java.util.List;
+
+/*******************************************************
+ * A micro-benchmark comparing the shared queue
+ * mode and the work-stealing mode of
+ * DynamicScheduler on fine-grained inputs. Each
+ * configuration runs warmup iterations followed
+ * by measured iterations, and the throughput is
+ * reported as mean and standard deviation of
+ * inputs per millisecond.
+ * 
+ * Usage: DynamicSchedulerBenchmark numThreads
+ * numInputs numPartitions partitionSize
+ * [numWarmups] [numIterations]
+ ******************************************************/
+public class DynamicSchedulerBenchmark {
+
+  /**
+   * The input of the benchmark task: a reference
+   * to one model partition
+   */
+  private static class BenchInput {
+    private final int partitionID;
+    private final double[] partition;
+
+    private BenchInput(int partitionID,
+      double[] partition) {
+      this.partitionID = partitionID;
+      this.partition = partition;
+    }
+  }
+
+  /**
+   * The benchmark task: a short pass over the
+   * model partition
+   */
+  private static class BenchTask
+    implements Task<BenchInput, Object> {
+    private double sum = 0.0;
+
+    @Override
+    public Object run(BenchInput input)
+      throws Exception {
+      double[] partition = input.partition;
+      for (int i = 0; i < partition.length; i++) {
+        partition[i] = partition[i] * 0.5 + 1.0;
+        sum += partition[i];
+      }
+      return input;
+    }
+  }
+
+  private static final String[] MODES =
+    { "shared", "stealing", "stealing+affinity",
+      "stealing+affinity+drain" };
+
+  public static void main(String args[])
+    throws Exception {
+    int numThreads = Integer.parseInt(args[0]);
+    int numInputs = Integer.parseInt(args[1]);
+    int numPartitions = Integer.parseInt(args[2]);
+    int partitionSize = Integer.parseInt(args[3]);
+    int numWarmups = args.length > 4
+      ? Integer.parseInt(args[4]) : 5;
+    int numIterations = args.length > 5
+      ? Integer.parseInt(args[5]) : 10;
+    System.out.println("threads=" + numThreads
+      + " inputs=" + numInputs + " partitions="
+      + numPartitions + " partitionSize="
+      + partitionSize + " warmups=" + numWarmups
+      + " iterations=" + numIterations);
+    double[][] partitions =
+      new double[numPartitions][partitionSize];
+    BenchInput[] inputs = new BenchInput[numInputs];
+    for (int i = 0; i < numInputs; i++) {
+      int partitionID = i % numPartitions;
+      inputs[i] = new BenchInput(partitionID,
+        partitions[partitionID]);
+    }
+    for (int mode = 0; mode < MODES.length; mode++) {
+      List<BenchTask> tasks =
+        new ObjectArrayList<>();
+      for (int i = 0; i < numThreads; i++) {
+        tasks.add(new BenchTask());
+      }
+      DynamicScheduler<BenchInput, Object, BenchTask> scheduler =
+        new DynamicScheduler<>(tasks, mode > 0);
+      if (mode > 1) {
+        scheduler.setAffinity(
+          input -> input.partitionID);
+      }
+      scheduler.start();
+      for (int i = 0; i < numWarmups; i++) {
+        runIteration(scheduler, inputs, mode > 2);
+      }
+      double[] throughputs =
+        new double[numIterations];
+      for (int i = 0; i < numIterations; i++) {
+        long startTime = System.nanoTime();
+        runIteration(scheduler, inputs, mode > 2);
+        long endTime = System.nanoTime();
+        throughputs[i] = (double) numInputs
+          * 1000000.0 / (double) (endTime - startTime);
+      }
+      scheduler.stop();
+      double mean = 0.0;
+      for (double throughput : throughputs) {
+        mean += throughput;
+      }
+      mean /= numIterations;
+      double var = 0.0;
+      for (double throughput : throughputs) {
+        var += (throughput - mean)
+          * (throughput - mean);
+      }
+      double stdDev = numIterations > 1
+        ? Math.sqrt(var / (numIterations - 1)) : 0.0;
+      System.out.println(String.format(
+        "%-26s %12.1f +- %10.1f inputs/ms",
+        MODES[mode], mean, stdDev));
+    }
+  }
+
+  /**
+   * Submit all the inputs and wait for all the
+   * outputs
+   */
+  private static void runIteration(
+    DynamicScheduler<BenchInput, Object, BenchTask> scheduler,
+    BenchInput[] inputs, boolean useDrain) {
+    scheduler.submitAll(inputs);
+    if (useDrain) {
+      List<Object> outputs =
+        new ObjectArrayList<>(inputs.length);
+      while (scheduler.hasOutput()) {
+        scheduler.drainOutputs(outputs);
+      }
+    } else {
+      while (scheduler.hasOutput()) {
+        scheduler.waitForOutput();
+      }
+    }
+  }
+}
@@ -0,0 +1,204 @@
+/*
+ * Copyright 2013-2017 Indiana University
+ * 
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+package edu.iu.harp.schdynamic;
+
+import java.util.concurrent.ConcurrentLinkedDeque;
+import java.util.concurrent.atomic.AtomicInteger;
+
+/*******************************************************
+ * The per-monitor input deques used by the
+ * work-stealing mode of DynamicScheduler. Each
+ * monitor takes inputs from the head of its own
+ * deque and steals from the tail of the others
+ * when its own deque is empty. Pause and stop
+ * are signaled through a shared state instead of
+ * in-band inputs so that they are never stolen.
+ ******************************************************/
+class TaskDeques<I> {
+
+  static final int RUNNING = 0;
+  static final int PAUSE = 1;
+  static final int PAUSE_NOW = 2;
+  static final int STOP = 3;
+
+  private final ConcurrentLinkedDeque<I>[] deques;
+  private final int numDeques;
+  private final AtomicInteger numIdle;
+  private final Object idleLock;
+  private volatile int state;
+
+  @SuppressWarnings("unchecked")
+  TaskDeques(int numDeques) {
+    this.numDeques = numDeques;
+    deques = new ConcurrentLinkedDeque[numDeques];
+    for (int i = 0; i < numDeques; i++) {
+      deques[i] = new ConcurrentLinkedDeque<>();
+    }
+    numIdle = new AtomicInteger(0);
+    idleLock = new Object();
+    state = RUNNING;
+  }
+
+  /**
+   * Get the number of deques
+   * 
+   * @return the number of deques
+   */
+  int getNumDeques() {
+    return numDeques;
+  }
+
+  /**
+   * Add the input to the tail of the deque
+   * 
+   * @param dequeID
+   *          the ID of the deque
+   * @param input
+   *          the input
+   */
+  void add(int dequeID, I input) {
+    deques[dequeID].addLast(input);
+  }
+
+  /**
+   * Wake up idle monitors after adding inputs
+   * 
+   * @param all
+   *          wake up all the idle monitors or
+   *          only one
+   */
+  void signal(boolean all) {
+    // The input is added before numIdle is read
+    // and a monitor increases numIdle before
+    // checking the deques, so no wakeup is lost
+    if (numIdle.get() > 0) {
+      synchronized (idleLock) {
+        if (all) {
+          idleLock.notifyAll();
+        } else {
+          idleLock.notify();
+        }
+      }
+    }
+  }
+
+  /**
+   * Take an input from the head of the own deque,
+   * or steal one from the tail of another deque
+   * 
+   * @param dequeID
+   *          the ID of the own deque
+   * @return the input, null if all the deques
+   *         are empty
+   */
+  I poll(int dequeID) {
+    I input = deques[dequeID].pollFirst();
+    if (input != null) {
+      return input;
+    }
+    for (int i = 1; i < numDeques; i++) {
+      int victim = dequeID + i;
+      if (victim >= numDeques) {
+        victim -= numDeques;
+      }
+      input = deques[victim].pollLast();
+      if (input != null) {
+        return input;
+      }
+    }
+    return null;
+  }
+
+  /**
+   * Block until there are inputs or the state is
+   * no longer RUNNING
+   */
+  void await() {
+    synchronized (idleLock) {
+      numIdle.incrementAndGet();
+      try {
+        while (state == RUNNING && isEmpty()) {
+          idleLock.wait();
+        }
+      } catch (InterruptedException e) {
+        // Return and let the monitor check again
+      } finally {
+        numIdle.decrementAndGet();
+      }
+    }
+  }
+
+  /**
+   * Get the state
+   * 
+   * @return the state
+   */
+  int getState() {
+    return state;
+  }
+
+  /**
+   * Set the state and wake up all the idle
+   * monitors
+   * 
+   * @param state
+   *          the new state
+   */
+  void setState(int state) {
+    this.state = state;
+    synchronized (idleLock) {
+      idleLock.notifyAll();
+    }
+  }
+
+  /**
+   * Check if all the deques are empty
+   * 
+   * @return true if empty, false otherwise
+   */
+  boolean isEmpty() {
+    for (int i = 0; i < numDeques; i++) {
+      if (!deques[i].isEmpty()) {
+        return false;
+      }
+    }
+    return true;
+  }
+
+  /**
+   * Get the total number of inputs in the deques.
+   * Only accurate when the monitors are paused.
+   * 
+   * @return the number of inputs
+   */
+  int size() {
+    int size = 0;
+    for (int i = 0; i < numDeques; i++) {
+      size += deques[i].size();
+    }
+    return size;
+  }
+
+  /**
+   * Remove all the inputs
+   */
+  void clear() {
+    for (int i = 0; i < numDeques; i++) {
+      deques[i].clear();
+    }
+  }
+}
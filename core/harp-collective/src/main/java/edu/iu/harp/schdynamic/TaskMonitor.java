@@ -36,6 +36,9 @@ public class TaskMonitor<I, O, T extends Task<I, O>>
   private final T taskObject;
   private final Semaphore barrier1;
   private final Semaphore barrier2;
+  // Only used in the work-stealing mode
+  private final int monitorID;
+  private final TaskDeques<I> taskDeques;
 
   TaskMonitor(BlockingDeque<Input<I>> inQueue,
     BlockingQueue<Output<O>> outQueue, T task,
@@ -45,6 +48,20 @@ public class TaskMonitor<I, O, T extends Task<I, O>>
     taskObject = task;
     this.barrier1 = barrier1;
     this.barrier2 = new Semaphore(0);
+    monitorID = -1;
+    taskDeques = null;
+  }
+
+  TaskMonitor(int monitorID, TaskDeques<I> deques,
+    BlockingQueue<Output<O>> outQueue, T task,
+    Semaphore barrier1) {
+    inputQueue = null;
+    outputQueue = outQueue;
+    taskObject = task;
+    this.barrier1 = barrier1;
+    this.barrier2 = new Semaphore(0);
+    this.monitorID = monitorID;
+    taskDeques = deques;
   }
 
   /**
@@ -60,6 +77,10 @@ public class TaskMonitor<I, O, T extends Task<I, O>>
    */
   @Override
   public void run() {
+    if (taskDeques != null) {
+      runStealing();
+      return;
+    }
     while (true) {
       try {
         Input<I> input = inputQueue.take();
@@ -70,24 +91,7 @@ public class TaskMonitor<I, O, T extends Task<I, O>>
             barrier1.release();
             ComputeUtil.acquire(barrier2);
           } else {
-            O output = null;
-            boolean isFailed = false;
-            try {
-              output =
-                taskObject.run(input.getInput());
-            } catch (Exception e) {
-              output = null;
-              isFailed = true;
-              LOG.error(
-                "Error when processing input", e);
-            }
-            if (isFailed) {
-              outputQueue
-                .add(new Output<>(null, true));
-            } else {
-              outputQueue
-                .add(new Output<>(output, false));
-            }
+            process(input.getInput());
           }
         }
       } catch (InterruptedException e) {
@@ -96,4 +100,61 @@ public class TaskMonitor<I, O, T extends Task<I, O>>
       }
     }
   }
+
+  /**
+   * The main process in the work-stealing mode.
+   * Inputs are taken from the own deque first and
+   * stolen from other deques when it is empty.
+   */
+  private void runStealing() {
+    while (true) {
+      int state = taskDeques.getState();
+      if (state == TaskDeques.PAUSE_NOW) {
+        pauseStealing();
+        continue;
+      }
+      I input = taskDeques.poll(monitorID);
+      if (input != null) {
+        process(input);
+      } else if (state == TaskDeques.PAUSE) {
+        pauseStealing();
+      } else if (state == TaskDeques.STOP) {
+        break;
+      } else {
+        taskDeques.await();
+      }
+    }
+  }
+
+  /**
+   * Notify the scheduler and wait to be released
+   */
+  private void pauseStealing() {
+    barrier1.release();
+    ComputeUtil.acquire(barrier2);
+  }
+
+  /**
+   * Run the task on the input and put the result
+   * to the output queue
+   * 
+   * @param input
+   *          the input
+   */
+  private void process(I input) {
+    O output = null;
+    boolean isFailed = false;
+    try {
+      output = taskObject.run(input);
+    } catch (Exception e) {
+      output = null;
+      isFailed = true;
+      LOG.error("Error when processing input", e);
+    }
+    if (isFailed) {
+      outputQueue.add(new Output<>(null, true));
+    } else {
+      outputQueue.add(new Output<>(output, false));
+    }
+  }
 }
@@ -26,6 +26,7 @@ import edu.iu.harp.io.Deserializer;
 import edu.iu.harp.io.EventQueue;
 import edu.iu.harp.io.IOUtil;
 import edu.iu.harp.resource.ByteArray;
+import edu.iu.harp.trace.Tracer;
 import edu.iu.harp.worker.WorkerInfo;
 import edu.iu.harp.worker.Workers;
 import org.apache.log4j.Logger;
@@ -80,7 +81,10 @@ public class DataChainBcastReceiver
     throws Exception {
     InputStream in = conn.getInputDtream();
     // Receive data
+    long startTime = Tracer.now();
     Data data = receiveData(in);
+    Tracer.get().recordRecv(data, startTime,
+      Tracer.now());
     if (this
       .getCommandType() == Constant.CHAIN_BCAST_DECODE) {
       // here only body array is decoded
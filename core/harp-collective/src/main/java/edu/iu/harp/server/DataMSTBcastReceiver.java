@@ -27,6 +27,7 @@ import edu.iu.harp.io.EventQueue;
 import edu.iu.harp.io.IOUtil;
 import edu.iu.harp.io.Serializer;
 import edu.iu.harp.resource.ByteArray;
+import edu.iu.harp.trace.Tracer;
 import edu.iu.harp.worker.WorkerInfo;
 import edu.iu.harp.worker.Workers;
 import org.apache.log4j.Logger;
@@ -80,7 +81,10 @@ public class DataMSTBcastReceiver
   protected void handleData(final ServerConn conn)
     throws Exception {
     // Receive data
+    long startTime = Tracer.now();
     Data data = receiveData(conn);
+    Tracer.get().recordRecv(data, startTime,
+      Tracer.now());
     if (this
       .getCommandType() == Constant.MST_BCAST_DECODE) {
       (new Decoder(data, selfID,
@@ -25,6 +25,7 @@ import edu.iu.harp.io.Deserializer;
 import edu.iu.harp.io.EventQueue;
 import edu.iu.harp.io.IOUtil;
 import edu.iu.harp.resource.ByteArray;
+import edu.iu.harp.trace.Tracer;
 import org.apache.log4j.Logger;
 
 import java.io.IOException;
@@ -55,7 +56,10 @@ public class DataReceiver extends Receiver {
     throws Exception {
     InputStream in = conn.getInputDtream();
     // Receive data
+    long startTime = Tracer.now();
     Data data = receiveData(in);
+    Tracer.get().recordRecv(data, startTime,
+      Tracer.now());
     if (this
       .getCommandType() == Constant.SEND_DECODE) {
       (new Decoder(data, selfID,
@@ -21,6 +21,7 @@ import edu.iu.harp.io.Data;
 import edu.iu.harp.io.DataMap;
 import edu.iu.harp.io.DataUtil;
 import edu.iu.harp.io.EventQueue;
+import edu.iu.harp.trace.Tracer;
 
 import java.util.concurrent.RecursiveAction;
 
@@ -53,7 +54,10 @@ public class Decoder extends RecursiveAction {
   @Override
   public void compute() {
     // Decode data array
+    long startTime = Tracer.now();
     data.decodeBodyArray();
+    Tracer.get().recordDecode(data, startTime,
+      Tracer.now());
     DataUtil.addDataToQueueOrMap(selfID,
       eventQueue, eventType, dataMap, data);
   }
@@ -0,0 +1,547 @@
+/*
+ * Copyright 2013-2017 Indiana University
+ * 
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+package edu.iu.harp.server;
+
+import edu.iu.harp.client.EventType;
+import edu.iu.harp.io.Constant;
+import edu.iu.harp.io.Data;
+import edu.iu.harp.io.DataMap;
+import edu.iu.harp.io.DataUtil;
+import edu.iu.harp.io.Deserializer;
+import edu.iu.harp.io.EventQueue;
+import edu.iu.harp.io.IOUtil;
+import edu.iu.harp.resource.ByteArray;
+import edu.iu.harp.schdynamic.ComputeUtil;
+import edu.iu.harp.trace.Tracer;
+import edu.iu.harp.worker.Workers;
+import it.unimi.dsi.fastutil.objects.ObjectArrayList;
+import org.apache.log4j.Logger;
+
+import java.io.ByteArrayInputStream;
+import java.io.IOException;
+import java.io.InputStream;
+import java.io.SequenceInputStream;
+import java.net.InetSocketAddress;
+import java.nio.ByteBuffer;
+import java.nio.channels.Channels;
+import java.nio.channels.SelectionKey;
+import java.nio.channels.Selector;
+import java.nio.channels.ServerSocketChannel;
+import java.nio.channels.SocketChannel;
+import java.util.Collections;
+import java.util.Iterator;
+import java.util.List;
+import java.util.concurrent.ConcurrentLinkedQueue;
+
+/*******************************************************
+ * The server based on NIO channels. One thread
+ * accepts connections and hands them to a small
+ * number of selector threads. Each selector
+ * thread reads from its channels into one direct
+ * buffer and copies the bytes to the pooled op,
+ * head and body arrays, so a single read can
+ * cover several small messages. The wire protocol
+ * is the same as Server. SEND and SEND_DECODE are
+ * handled in the selector threads; the broadcast
+ * commands forward data while receiving, so their
+ * connections are switched back to blocking mode
+ * and handled by Acceptor threads.
+ ******************************************************/
+public class NIOServer implements Runnable {
+
+  private static final Logger LOG =
+    Logger.getLogger(NIOServer.class);
+
+  private final EventQueue eventQueue;
+  private final DataMap dataMap;
+  private final Workers workers;
+  private final int selfID;
+  private final ServerSocketChannel serverChannel;
+  private final Thread server;
+  private final SelectorThread[] selectors;
+  /** Acceptor threads for broadcast connections */
+  private final List<Thread> acceptors;
+  private volatile boolean isRunning;
+
+  /*******************************************************
+   * The receiving state of a channel
+   ******************************************************/
+  private class ChannelState {
+    private byte commandType =
+      Constant.UNKNOWN_CMD;
+    /** The array being filled */
+    private ByteArray target = null;
+    private int pos = 0;
+    private ByteArray opArray = null;
+    private ByteArray headArray = null;
+    private Data data = null;
+    /** The time when the command arrived */
+    private long startTime = 0L;
+
+    /**
+     * Reset to wait for the next command
+     */
+    private void reset() {
+      commandType = Constant.UNKNOWN_CMD;
+      startTime = 0L;
+      target = null;
+      pos = 0;
+      opArray = null;
+      headArray = null;
+      data = null;
+    }
+
+    /**
+     * Release the arrays of the partially
+     * received data
+     */
+    private void release() {
+      if (opArray != null) {
+        opArray.release();
+      }
+      if (data != null) {
+        data.releaseHeadArray();
+        data.releaseBodyArray();
+      } else if (headArray != null) {
+        headArray.release();
+      }
+      reset();
+    }
+  }
+
+  /*******************************************************
+   * A connection to be handled by an Acceptor
+   ******************************************************/
+  private class Handoff {
+    private final SocketChannel channel;
+    private final byte commandType;
+    private final byte[] remaining;
+
+    private Handoff(SocketChannel channel,
+      byte commandType, byte[] remaining) {
+      this.channel = channel;
+      this.commandType = commandType;
+      this.remaining = remaining;
+    }
+  }
+
+  /*******************************************************
+   * The thread for reading from a set of channels
+   ******************************************************/
+  private class SelectorThread extends Thread {
+    private final Selector selector;
+    private final ByteBuffer buffer;
+    private final ConcurrentLinkedQueue<SocketChannel> newChannels;
+    private final List<Handoff> handoffs;
+
+    private SelectorThread() throws IOException {
+      selector = Selector.open();
+      buffer = ByteBuffer
+        .allocateDirect(Constant.BUFFER_SIZE);
+      newChannels = new ConcurrentLinkedQueue<>();
+      handoffs = new ObjectArrayList<>();
+    }
+
+    /**
+     * Add a new channel, it is registered by
+     * this thread.
+     * 
+     * @param channel
+     *          the SocketChannel
+     */
+    private void addChannel(
+      SocketChannel channel) {
+      newChannels.add(channel);
+      selector.wakeup();
+    }
+
+    /**
+     * The overridden run function for reading
+     * from channels
+     */
+    @Override
+    public void run() {
+      while (isRunning) {
+        try {
+          // Keys selected by selectNow() in
+          // startAcceptors are not reported again
+          if (selector.selectedKeys().isEmpty()) {
+            selector.select();
+          }
+        } catch (IOException e) {
+          LOG.error("Exception on selector", e);
+          continue;
+        }
+        SocketChannel channel = null;
+        while ((channel =
+          newChannels.poll()) != null) {
+          try {
+            channel.register(selector,
+              SelectionKey.OP_READ,
+              new ChannelState());
+          } catch (IOException e) {
+            LOG.error("Fail to register channel",
+              e);
+            closeChannel(channel, null);
+          }
+        }
+        Iterator<SelectionKey> iterator =
+          selector.selectedKeys().iterator();
+        while (iterator.hasNext()) {
+          SelectionKey key = iterator.next();
+          iterator.remove();
+          if (key.isValid() && key.isReadable()) {
+            read(key);
+          }
+        }
+        if (!handoffs.isEmpty()) {
+          startAcceptors();
+        }
+      }
+      for (SelectionKey key : selector.keys()) {
+        closeChannel((SocketChannel) key.channel(),
+          (ChannelState) key.attachment());
+      }
+      try {
+        selector.close();
+      } catch (IOException e) {
+      }
+    }
+
+    /**
+     * Read from a channel and process the bytes
+     * 
+     * @param key
+     *          the SelectionKey of the channel
+     */
+    private void read(SelectionKey key) {
+      SocketChannel channel =
+        (SocketChannel) key.channel();
+      ChannelState state =
+        (ChannelState) key.attachment();
+      buffer.clear();
+      try {
+        int len = channel.read(buffer);
+        if (len < 0) {
+          key.cancel();
+          closeChannel(channel, state);
+          return;
+        }
+        buffer.flip();
+        while (buffer.hasRemaining()) {
+          if (!process(key, channel, state)) {
+            return;
+          }
+        }
+      } catch (Exception e) {
+        LOG.error("Exception on NIO server", e);
+        key.cancel();
+        closeChannel(channel, state);
+      }
+    }
+
+    /**
+     * Process the bytes in the buffer
+     * 
+     * @param key
+     *          the SelectionKey of the channel
+     * @param channel
+     *          the SocketChannel
+     * @param state
+     *          the receiving state
+     * @return true if the channel continues to be
+     *         read by this thread
+     * @throws Exception
+     */
+    private boolean process(SelectionKey key,
+      SocketChannel channel, ChannelState state)
+      throws Exception {
+      if (state.target == null) {
+        // All commands should use positive byte
+        // integer 0 ~ 127
+        state.commandType = buffer.get();
+        if (state.commandType == Constant.SEND
+          || state.commandType == Constant.SEND_DECODE) {
+          state.startTime = Tracer.now();
+          state.opArray =
+            ByteArray.create(4, true);
+          state.target = state.opArray;
+          state.pos = 0;
+          return true;
+        } else if (state.commandType == Constant.CHAIN_BCAST
+          || state.commandType == Constant.CHAIN_BCAST_DECODE
+          || state.commandType == Constant.MST_BCAST
+          || state.commandType == Constant.MST_BCAST_DECODE) {
+          byte[] remaining =
+            new byte[buffer.remaining()];
+          buffer.get(remaining);
+          key.cancel();
+          handoffs.add(new Handoff(channel,
+            state.commandType, remaining));
+          return false;
+        } else {
+          if (state.commandType == Constant.SERVER_QUIT) {
+            shutdown();
+          } else if (state.commandType != Constant.CONNECTION_END) {
+            LOG.info("Unknown command: "
+              + state.commandType);
+          }
+          key.cancel();
+          closeChannel(channel, state);
+          return false;
+        }
+      }
+      // Fill the target array
+      int len =
+        Math.min(buffer.remaining(),
+          state.target.size() - state.pos);
+      buffer.get(state.target.get(),
+        state.target.start() + state.pos, len);
+      state.pos += len;
+      if (state.pos < state.target.size()) {
+        return true;
+      }
+      if (state.target == state.opArray) {
+        Deserializer deserializer =
+          new Deserializer(state.opArray);
+        int headArrSize = deserializer.readInt();
+        state.opArray.release();
+        state.opArray = null;
+        state.headArray =
+          ByteArray.create(headArrSize, true);
+        if (state.headArray == null) {
+          throw new Exception("Null head array");
+        }
+        state.target = state.headArray;
+        state.pos = 0;
+      } else if (state.target == state.headArray) {
+        // Prepare bytes from resource pool
+        // Sending or receiving null array is
+        // allowed
+        state.data = new Data(state.headArray);
+        state.data.decodeHeadArray();
+        ByteArray bodyArray =
+          state.data.getBodyArray();
+        if (bodyArray != null) {
+          state.target = bodyArray;
+          state.pos = 0;
+        } else {
+          dispatch(state);
+        }
+      } else {
+        dispatch(state);
+      }
+      return true;
+    }
+
+    /**
+     * Start Acceptors for the broadcast
+     * connections. The cancelled keys are removed
+     * from the selector before the channels are
+     * switched to blocking mode.
+     */
+    private void startAcceptors() {
+      try {
+        selector.selectNow();
+      } catch (IOException e) {
+        LOG.error("Exception on selector", e);
+      }
+      for (Handoff handoff : handoffs) {
+        try {
+          handoff.channel.configureBlocking(true);
+          InputStream in = new SequenceInputStream(
+            new ByteArrayInputStream(
+              handoff.remaining),
+            Channels
+              .newInputStream(handoff.channel));
+          ServerConn conn = new ServerConn(in,
+            handoff.channel.socket());
+          Acceptor acceptor =
+            new Acceptor(conn, eventQueue,
+              dataMap, workers,
+              handoff.commandType);
+          Thread thread = new Thread(acceptor);
+          thread.start();
+          acceptors.add(thread);
+        } catch (IOException e) {
+          LOG.error("Fail to start acceptor", e);
+          closeChannel(handoff.channel, null);
+        }
+      }
+      handoffs.clear();
+    }
+  }
+
+  /**
+   * Initialization
+   * 
+   * @param node
+   *          the host
+   * @param port
+   *          the port
+   * @param queue
+   *          the EventQueue
+   * @param map
+   *          the DataMap
+   * @param workers
+   *          the Workers
+   * @throws Exception
+   */
+  public NIOServer(String node, int port,
+    EventQueue queue, DataMap map,
+    Workers workers) throws Exception {
+    this.eventQueue = queue;
+    this.dataMap = map;
+    this.workers = workers;
+    this.selfID = workers.getSelfID();
+    server = new Thread(this);
+    acceptors = Collections
+      .synchronizedList(new ObjectArrayList<>());
+    serverChannel = ServerSocketChannel.open();
+    IOUtil
+      .setServerSocketOptions(serverChannel.socket());
+    serverChannel.socket()
+      .bind(new InetSocketAddress(node, port));
+    selectors =
+      new SelectorThread[Constant.NUM_SELECTORS];
+    for (int i = 0; i < selectors.length; i++) {
+      selectors[i] = new SelectorThread();
+    }
+    isRunning = false;
+  }
+
+  /**
+   * Start the server
+   */
+  public void start() {
+    isRunning = true;
+    for (SelectorThread thread : selectors) {
+      thread.start();
+    }
+    server.start();
+  }
+
+  /**
+   * Wait for the Acceptors of the broadcast
+   * connections
+   */
+  void joinAcceptors() {
+    Thread[] threads = null;
+    synchronized (acceptors) {
+      threads = acceptors.toArray(new Thread[0]);
+    }
+    for (Thread thread : threads) {
+      ComputeUtil.joinThread(thread);
+    }
+  }
+
+  /**
+   * Wait for the server threads, called after
+   * SERVER_QUIT is sent
+   */
+  void join() {
+    ComputeUtil.joinThread(server);
+    for (SelectorThread thread : selectors) {
+      ComputeUtil.joinThread(thread);
+    }
+  }
+
+  /**
+   * Stop accepting and reading, called when
+   * SERVER_QUIT is received
+   */
+  private void shutdown() {
+    isRunning = false;
+    try {
+      serverChannel.close();
+    } catch (IOException e) {
+      LOG.error("Fail to stop the server.", e);
+    }
+    for (SelectorThread thread : selectors) {
+      thread.selector.wakeup();
+    }
+  }
+
+  /**
+   * Dispatch the received data
+   * 
+   * @param state
+   *          the receiving state
+   */
+  private void dispatch(ChannelState state) {
+    Data data = state.data;
+    Tracer.get().recordRecv(data, state.startTime,
+      Tracer.now());
+    if (state.commandType == Constant.SEND_DECODE) {
+      (new Decoder(data, selfID,
+        EventType.MESSAGE_EVENT, eventQueue,
+        dataMap)).fork();
+    } else {
+      DataUtil.addDataToQueueOrMap(selfID,
+        eventQueue, EventType.MESSAGE_EVENT,
+        dataMap, data);
+    }
+    state.reset();
+  }
+
+  /**
+   * Close the channel and release the partially
+   * received data
+   * 
+   * @param channel
+   *          the SocketChannel
+   * @param state
+   *          the receiving state, can be null
+   */
+  private void closeChannel(SocketChannel channel,
+    ChannelState state) {
+    if (state != null) {
+      state.release();
+    }
+    try {
+      channel.close();
+    } catch (IOException e) {
+    }
+  }
+
+  /**
+   * The overridden run function for accepting
+   * connections
+   */
+  @Override
+  public void run() {
+    int next = 0;
+    while (isRunning) {
+      SocketChannel channel = null;
+      try {
+        channel = serverChannel.accept();
+        IOUtil.setSocketOptions(channel.socket());
+        channel.configureBlocking(false);
+      } catch (Exception e) {
+        if (isRunning) {
+          LOG.error("Exception on NIO server", e);
+        }
+        if (channel != null) {
+          closeChannel(channel, null);
+        }
+        continue;
+      }
+      selectors[next].addChannel(channel);
+      next = (next + 1) % selectors.length;
+    }
+  }
+}
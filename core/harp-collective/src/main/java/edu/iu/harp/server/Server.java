@@ -62,6 +62,8 @@ public class Server implements Runnable {
   private final int port;
   /** Server socket */
   private final ServerSocket serverSocket;
+  /** The NIO server, null if not used */
+  private final NIOServer nioServer;
 
   /**
    * Initialization
@@ -81,6 +83,31 @@ public class Server implements Runnable {
   public Server(String node, int port,
     EventQueue queue, DataMap map,
     Workers workers) throws Exception {
+    this(node, port, queue, map, workers, false);
+  }
+
+  /**
+   * Initialization
+   * 
+   * @param node
+   *          the host
+   * @param port
+   *          the port
+   * @param queue
+   *          the EventQueue
+   * @param map
+   *          the DataMap
+   * @param workers
+   *          the Workers
+   * @param useNIO
+   *          if NIOServer is used to receive the
+   *          data
+   * @throws Exception
+   */
+  public Server(String node, int port,
+    EventQueue queue, DataMap map,
+    Workers workers, boolean useNIO)
+    throws Exception {
     this.eventQueue = queue;
     this.dataMap = map;
     server = new Thread(this);
@@ -91,10 +118,18 @@ public class Server implements Runnable {
     this.port = port;
     // Server socket
     try {
-      serverSocket = new ServerSocket();
-      IOUtil.setServerSocketOptions(serverSocket);
-      serverSocket
-        .bind(new InetSocketAddress(node, port));
+      if (useNIO) {
+        serverSocket = null;
+        nioServer = new NIOServer(node, port,
+          queue, map, workers);
+      } else {
+        serverSocket = new ServerSocket();
+        IOUtil
+          .setServerSocketOptions(serverSocket);
+        serverSocket
+          .bind(new InetSocketAddress(node, port));
+        nioServer = null;
+      }
     } catch (Exception e) {
       LOG.error("Error in starting receiver.", e);
       throw new Exception(e);
@@ -107,7 +142,11 @@ public class Server implements Runnable {
    * Start the server
    */
   public void start() {
-    server.start();
+    if (nioServer != null) {
+      nioServer.start();
+    } else {
+      server.start();
+    }
   }
 
   /**
@@ -115,6 +154,14 @@ public class Server implements Runnable {
    * server
    */
   public void stop() {
+    if (nioServer != null) {
+      nioServer.joinAcceptors();
+      closeServer(this.node, this.port);
+      nioServer.join();
+      LOG.info("Server on " + this.node + " "
+        + this.port + " is stopped.");
+      return;
+    }
     for (Thread thread : acceptors) {
       ComputeUtil.joinThread(thread);
     }
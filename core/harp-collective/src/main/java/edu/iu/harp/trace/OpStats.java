@@ -0,0 +1,193 @@
+/*
+ * Copyright 2013-2017 Indiana University
+ * 
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+package edu.iu.harp.trace;
+
+import java.util.concurrent.atomic.LongAdder;
+
+/*******************************************************
+ * The counters of one operation under one
+ * context. The counters are updated concurrently
+ * by the collective, sending, receiving and
+ * decoding threads. Times are in nanoseconds.
+ ******************************************************/
+public class OpStats {
+
+  /** The collective which started the operation */
+  private volatile String collective;
+
+  final LongAdder numOps;
+  final LongAdder numFailures;
+  final LongAdder opNanos;
+  final LongAdder numSends;
+  final LongAdder bytesSent;
+  final LongAdder serNanos;
+  final LongAdder sendNanos;
+  final LongAdder numRecvs;
+  final LongAdder bytesRecv;
+  final LongAdder recvNanos;
+  final LongAdder numDecodes;
+  final LongAdder deserNanos;
+  final LongAdder numWaits;
+  final LongAdder waitNanos;
+  final LongAdder numTimeouts;
+  final LongAdder poolHits;
+  final LongAdder poolMisses;
+
+  OpStats() {
+    collective = null;
+    numOps = new LongAdder();
+    numFailures = new LongAdder();
+    opNanos = new LongAdder();
+    numSends = new LongAdder();
+    bytesSent = new LongAdder();
+    serNanos = new LongAdder();
+    sendNanos = new LongAdder();
+    numRecvs = new LongAdder();
+    bytesRecv = new LongAdder();
+    recvNanos = new LongAdder();
+    numDecodes = new LongAdder();
+    deserNanos = new LongAdder();
+    numWaits = new LongAdder();
+    waitNanos = new LongAdder();
+    numTimeouts = new LongAdder();
+    poolHits = new LongAdder();
+    poolMisses = new LongAdder();
+  }
+
+  void setCollective(String collective) {
+    if (this.collective == null) {
+      this.collective = collective;
+    }
+  }
+
+  public String getCollective() {
+    return collective;
+  }
+
+  public long getNumOps() {
+    return numOps.sum();
+  }
+
+  public long getNumFailures() {
+    return numFailures.sum();
+  }
+
+  public long getOpNanos() {
+    return opNanos.sum();
+  }
+
+  public long getNumSends() {
+    return numSends.sum();
+  }
+
+  public long getBytesSent() {
+    return bytesSent.sum();
+  }
+
+  /**
+   * Get the time spent on encoding the data
+   * before sending
+   * 
+   * @return the serialization time
+   */
+  public long getSerNanos() {
+    return serNanos.sum();
+  }
+
+  /**
+   * Get the time spent on writing the encoded
+   * data to the connections
+   * 
+   * @return the network time of sending
+   */
+  public long getSendNanos() {
+    return sendNanos.sum();
+  }
+
+  public long getNumRecvs() {
+    return numRecvs.sum();
+  }
+
+  public long getBytesRecv() {
+    return bytesRecv.sum();
+  }
+
+  /**
+   * Get the time spent on reading the data from
+   * the connections
+   * 
+   * @return the network time of receiving
+   */
+  public long getRecvNanos() {
+    return recvNanos.sum();
+  }
+
+  public long getNumDecodes() {
+    return numDecodes.sum();
+  }
+
+  /**
+   * Get the time spent on decoding the received
+   * data
+   * 
+   * @return the deserialization time
+   */
+  public long getDeserNanos() {
+    return deserNanos.sum();
+  }
+
+  public long getNumWaits() {
+    return numWaits.sum();
+  }
+
+  /**
+   * Get the time the collective threads were
+   * blocked waiting for data
+   * 
+   * @return the wait time
+   */
+  public long getWaitNanos() {
+    return waitNanos.sum();
+  }
+
+  public long getNumTimeouts() {
+    return numTimeouts.sum();
+  }
+
+  public long getPoolHits() {
+    return poolHits.sum();
+  }
+
+  public long getPoolMisses() {
+    return poolMisses.sum();
+  }
+
+  /**
+   * Get the hit rate of the array pools during
+   * the operations
+   * 
+   * @return the hit rate, -1 if no array was
+   *         requested
+   */
+  public double getPoolHitRate() {
+    long hits = poolHits.sum();
+    long total = hits + poolMisses.sum();
+    return total == 0L ? -1.0
+      : (double) hits / (double) total;
+  }
+}
@@ -0,0 +1,50 @@
+/*
+ * Copyright 2013-2017 Indiana University
+ * 
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+package edu.iu.harp.trace;
+
+/*******************************************************
+ * One span on the timeline of a worker
+ ******************************************************/
+class TraceEvent {
+
+  final String name;
+  final String category;
+  final String contextName;
+  final String operationName;
+  final long threadID;
+  /** The start time in nanoseconds */
+  final long start;
+  /** The end time in nanoseconds */
+  final long end;
+  /** The number of bytes, -1 if not applicable */
+  final long bytes;
+
+  TraceEvent(String name, String category,
+    String contextName, String operationName,
+    long threadID, long start, long end,
+    long bytes) {
+    this.name = name;
+    this.category = category;
+    this.contextName = contextName;
+    this.operationName = operationName;
+    this.threadID = threadID;
+    this.start = start;
+    this.end = end;
+    this.bytes = bytes;
+  }
+}
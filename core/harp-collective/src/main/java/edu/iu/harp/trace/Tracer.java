@@ -0,0 +1,630 @@
+/*
+ * Copyright 2013-2017 Indiana University
+ * 
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+package edu.iu.harp.trace;
+
+import edu.iu.harp.io.Data;
+import edu.iu.harp.resource.ByteArray;
+import edu.iu.harp.resource.ResourcePool;
+
+import java.io.BufferedWriter;
+import java.io.IOException;
+import java.io.OutputStream;
+import java.io.OutputStreamWriter;
+import java.io.Writer;
+import java.nio.charset.StandardCharsets;
+import java.util.Map;
+import java.util.TreeMap;
+import java.util.concurrent.ConcurrentHashMap;
+import java.util.concurrent.ConcurrentLinkedQueue;
+import java.util.concurrent.ConcurrentMap;
+import java.util.concurrent.atomic.AtomicInteger;
+import java.util.concurrent.atomic.LongAdder;
+import java.util.function.BooleanSupplier;
+
+/*******************************************************
+ * The tracer of the collective communication on
+ * this worker. Counters are always kept per
+ * context and operation. Digits in operation
+ * names are folded to '#', so the operations of
+ * different iterations share one entry. Spans
+ * are only kept for the timeline when it is
+ * enabled, up to a maximum number of events.
+ ******************************************************/
+public class Tracer {
+
+  /** The default maximum number of events */
+  public static final int DEFAULT_MAX_EVENTS =
+    1 << 20;
+
+  private static Tracer instance = null;
+
+  private final ConcurrentMap<String, ConcurrentMap<String, OpStats>> stats;
+  private final ConcurrentLinkedQueue<TraceEvent> events;
+  private final AtomicInteger numEvents;
+  private final LongAdder numDroppedEvents;
+  private final ThreadLocal<OpFrame> frames;
+  /** Wall clock time in microseconds at nanoTime 0 */
+  private final long baseMicros;
+  private volatile int workerID;
+  private volatile boolean isTimelineEnabled;
+  private volatile int maxEvents;
+
+  /*******************************************************
+   * The operations in progress on a thread. Only
+   * the outermost one is counted, so a collective
+   * calling other collectives is counted once.
+   ******************************************************/
+  private static class OpFrame {
+    private int depth = 0;
+    private long poolHits = 0L;
+    private long poolMisses = 0L;
+  }
+
+  private Tracer() {
+    stats = new ConcurrentHashMap<>();
+    events = new ConcurrentLinkedQueue<>();
+    numEvents = new AtomicInteger(0);
+    numDroppedEvents = new LongAdder();
+    frames = ThreadLocal.withInitial(OpFrame::new);
+    baseMicros = System.currentTimeMillis() * 1000L
+      - System.nanoTime() / 1000L;
+    workerID = -1;
+    isTimelineEnabled = false;
+    maxEvents = DEFAULT_MAX_EVENTS;
+  }
+
+  public static Tracer get() {
+    if (instance != null) {
+      return instance;
+    } else {
+      return create();
+    }
+  }
+
+  private static synchronized Tracer create() {
+    if (instance == null) {
+      instance = new Tracer();
+    }
+    return instance;
+  }
+
+  /**
+   * Get the current time
+   * 
+   * @return the current time in nanoseconds
+   */
+  public static long now() {
+    return System.nanoTime();
+  }
+
+  /**
+   * Set the worker ID, used as the process ID on
+   * the timeline
+   * 
+   * @param workerID
+   *          the worker ID
+   */
+  public void setWorkerID(int workerID) {
+    this.workerID = workerID;
+  }
+
+  /**
+   * Enable or disable the timeline
+   * 
+   * @param enabled
+   *          if the spans are kept
+   */
+  public void setTimelineEnabled(boolean enabled) {
+    this.isTimelineEnabled = enabled;
+  }
+
+  public boolean isTimelineEnabled() {
+    return isTimelineEnabled;
+  }
+
+  /**
+   * Set the maximum number of events kept for
+   * the timeline. Later events are dropped.
+   * 
+   * @param maxEvents
+   *          the maximum number of events
+   */
+  public void setMaxEvents(int maxEvents) {
+    this.maxEvents = maxEvents;
+  }
+
+  /**
+   * Begin an operation on this thread
+   * 
+   * @return the start time
+   */
+  public long beginOp() {
+    OpFrame frame = frames.get();
+    if (frame.depth++ == 0) {
+      ResourcePool pool = ResourcePool.get();
+      frame.poolHits = pool.getNumArrayHits();
+      frame.poolMisses = pool.getNumArrayMisses();
+    }
+    return now();
+  }
+
+  /**
+   * End the operation begun on this thread
+   * 
+   * @param contextName
+   *          the name of the context
+   * @param operationName
+   *          the name of the operation
+   * @param collective
+   *          the name of the collective
+   * @param start
+   *          the time returned by beginOp
+   * @param isSuccess
+   *          if the operation succeeded
+   */
+  public void endOp(String contextName,
+    String operationName, String collective,
+    long start, boolean isSuccess) {
+    long end = now();
+    OpFrame frame = frames.get();
+    if (--frame.depth == 0) {
+      OpStats opStats =
+        getStats(contextName, operationName);
+      opStats.setCollective(collective);
+      opStats.numOps.increment();
+      opStats.opNanos.add(end - start);
+      if (!isSuccess) {
+        opStats.numFailures.increment();
+      }
+      // The pools are shared by all the threads,
+      // so the deltas also include the arrays
+      // used by concurrent computation
+      ResourcePool pool = ResourcePool.get();
+      opStats.poolHits.add(
+        pool.getNumArrayHits() - frame.poolHits);
+      opStats.poolMisses.add(
+        pool.getNumArrayMisses() - frame.poolMisses);
+    }
+    addEvent(collective, "op", contextName,
+      operationName, start, end, -1L);
+  }
+
+  /**
+   * Trace an operation
+   * 
+   * @param contextName
+   *          the name of the context
+   * @param operationName
+   *          the name of the operation
+   * @param collective
+   *          the name of the collective
+   * @param operation
+   *          the operation
+   * @return the result of the operation
+   */
+  public boolean traceOp(String contextName,
+    String operationName, String collective,
+    BooleanSupplier operation) {
+    long start = beginOp();
+    boolean isSuccess = false;
+    try {
+      isSuccess = operation.getAsBoolean();
+      return isSuccess;
+    } finally {
+      endOp(contextName, operationName,
+        collective, start, isSuccess);
+    }
+  }
+
+  /**
+   * Record sending the data
+   * 
+   * @param data
+   *          the data
+   * @param start
+   *          the time before encoding
+   * @param encoded
+   *          the time after encoding
+   * @param end
+   *          the time after sending
+   * @param isSuccess
+   *          if the data was sent
+   */
+  public void recordSend(Data data, long start,
+    long encoded, long end, boolean isSuccess) {
+    OpStats opStats = getStats(
+      data.getContextName(),
+      data.getOperationName());
+    long bytes = getNumBytes(data);
+    opStats.numSends.increment();
+    opStats.serNanos.add(encoded - start);
+    opStats.sendNanos.add(end - encoded);
+    if (isSuccess) {
+      opStats.bytesSent.add(bytes);
+    } else {
+      opStats.numFailures.increment();
+    }
+    if (isTimelineEnabled) {
+      addEvent("encode", "ser",
+        data.getContextName(),
+        data.getOperationName(), start, encoded,
+        -1L);
+      addEvent("send", "net",
+        data.getContextName(),
+        data.getOperationName(), encoded, end,
+        bytes);
+    }
+  }
+
+  /**
+   * Record receiving the data
+   * 
+   * @param data
+   *          the data
+   * @param start
+   *          the time before reading the data
+   * @param end
+   *          the time after reading the data
+   */
+  public void recordRecv(Data data, long start,
+    long end) {
+    OpStats opStats = getStats(
+      data.getContextName(),
+      data.getOperationName());
+    long bytes = getNumBytes(data);
+    opStats.numRecvs.increment();
+    opStats.bytesRecv.add(bytes);
+    opStats.recvNanos.add(end - start);
+    addEvent("recv", "net", data.getContextName(),
+      data.getOperationName(), start, end, bytes);
+  }
+
+  /**
+   * Record decoding the data
+   * 
+   * @param data
+   *          the data
+   * @param start
+   *          the time before decoding
+   * @param end
+   *          the time after decoding
+   */
+  public void recordDecode(Data data, long start,
+    long end) {
+    OpStats opStats = getStats(
+      data.getContextName(),
+      data.getOperationName());
+    opStats.numDecodes.increment();
+    opStats.deserNanos.add(end - start);
+    addEvent("decode", "ser",
+      data.getContextName(),
+      data.getOperationName(), start, end, -1L);
+  }
+
+  /**
+   * Record waiting for the data of an operation
+   * 
+   * @param contextName
+   *          the name of the context
+   * @param operationName
+   *          the name of the operation
+   * @param start
+   *          the time before waiting
+   * @param end
+   *          the time after waiting
+   * @param isTimeout
+   *          if no data arrived
+   */
+  public void recordWait(String contextName,
+    String operationName, long start, long end,
+    boolean isTimeout) {
+    OpStats opStats =
+      getStats(contextName, operationName);
+    opStats.numWaits.increment();
+    opStats.waitNanos.add(end - start);
+    if (isTimeout) {
+      opStats.numTimeouts.increment();
+    }
+    addEvent("wait", "wait", contextName,
+      operationName, start, end, -1L);
+  }
+
+  /**
+   * Get the counters of an operation. Digits in
+   * the operation name are folded.
+   * 
+   * @param contextName
+   *          the name of the context
+   * @param operationName
+   *          the name of the operation
+   * @return the counters
+   */
+  public OpStats getStats(String contextName,
+    String operationName) {
+    String ctx =
+      contextName == null ? "" : contextName;
+    ConcurrentMap<String, OpStats> opStatsMap =
+      stats.get(ctx);
+    if (opStatsMap == null) {
+      opStatsMap = new ConcurrentHashMap<>();
+      ConcurrentMap<String, OpStats> oldMap =
+        stats.putIfAbsent(ctx, opStatsMap);
+      if (oldMap != null) {
+        opStatsMap = oldMap;
+      }
+    }
+    String op = foldDigits(operationName);
+    OpStats opStats = opStatsMap.get(op);
+    if (opStats == null) {
+      opStats = new OpStats();
+      OpStats oldStats =
+        opStatsMap.putIfAbsent(op, opStats);
+      if (oldStats != null) {
+        opStats = oldStats;
+      }
+    }
+    return opStats;
+  }
+
+  /**
+   * Replace each run of digits with '#'
+   * 
+   * @param name
+   *          the operation name
+   * @return the folded name
+   */
+  static String foldDigits(String name) {
+    if (name == null) {
+      return "";
+    }
+    int len = name.length();
+    int i = 0;
+    while (i < len && !isDigit(name.charAt(i))) {
+      i++;
+    }
+    if (i == len) {
+      return name;
+    }
+    StringBuilder sb = new StringBuilder(len);
+    sb.append(name, 0, i);
+    boolean inDigits = false;
+    for (; i < len; i++) {
+      char c = name.charAt(i);
+      if (isDigit(c)) {
+        if (!inDigits) {
+          sb.append('#');
+          inDigits = true;
+        }
+      } else {
+        sb.append(c);
+        inDigits = false;
+      }
+    }
+    return sb.toString();
+  }
+
+  private static boolean isDigit(char c) {
+    return c >= '0' && c <= '9';
+  }
+
+  /**
+   * Get the number of bytes of the encoded data
+   * 
+   * @param data
+   *          the data
+   * @return the number of bytes
+   */
+  private static long getNumBytes(Data data) {
+    long bytes = 0L;
+    ByteArray headArray = data.getHeadArray();
+    if (headArray != null) {
+      bytes += headArray.size();
+    }
+    ByteArray bodyArray = data.getBodyArray();
+    if (bodyArray != null) {
+      bytes += bodyArray.size();
+    }
+    return bytes;
+  }
+
+  private void addEvent(String name,
+    String category, String contextName,
+    String operationName, long start, long end,
+    long bytes) {
+    if (!isTimelineEnabled) {
+      return;
+    }
+    if (numEvents.incrementAndGet() > maxEvents) {
+      numEvents.decrementAndGet();
+      numDroppedEvents.increment();
+      return;
+    }
+    events.add(new TraceEvent(name, category,
+      contextName, operationName,
+      Thread.currentThread().getId(), start, end,
+      bytes));
+  }
+
+  /**
+   * Get the summary of the counters, sorted by
+   * context and operation
+   * 
+   * @return the summary
+   */
+  public String getSummary() {
+    StringBuilder sb = new StringBuilder();
+    sb.append("Collective trace summary of worker ")
+      .append(workerID).append('\n');
+    sb.append("context\toperation\tcollective"
+      + "\tops\tfailures\top(ms)\tsends"
+      + "\tsent(MB)\tser(ms)\tsend(ms)\trecvs"
+      + "\trecv(MB)\trecv(ms)\tdeser(ms)\twaits"
+      + "\twait(ms)\ttimeouts\tpool hit rate\n");
+    Map<String, Map<String, OpStats>> sorted =
+      new TreeMap<>();
+    for (Map.Entry<String, ConcurrentMap<String, OpStats>> entry : stats
+      .entrySet()) {
+      sorted.put(entry.getKey(),
+        new TreeMap<>(entry.getValue()));
+    }
+    for (Map.Entry<String, Map<String, OpStats>> ctxEntry : sorted
+      .entrySet()) {
+      for (Map.Entry<String, OpStats> opEntry : ctxEntry
+        .getValue().entrySet()) {
+        OpStats s = opEntry.getValue();
+        sb.append(ctxEntry.getKey()).append('\t')
+          .append(opEntry.getKey()).append('\t')
+          .append(s.getCollective() == null ? "-"
+            : s.getCollective())
+          .append('\t').append(s.getNumOps())
+          .append('\t').append(s.getNumFailures())
+          .append('\t').append(toMs(s.getOpNanos()))
+          .append('\t').append(s.getNumSends())
+          .append('\t')
+          .append(toMB(s.getBytesSent()))
+          .append('\t').append(toMs(s.getSerNanos()))
+          .append('\t')
+          .append(toMs(s.getSendNanos()))
+          .append('\t').append(s.getNumRecvs())
+          .append('\t')
+          .append(toMB(s.getBytesRecv()))
+          .append('\t')
+          .append(toMs(s.getRecvNanos()))
+          .append('\t')
+          .append(toMs(s.getDeserNanos()))
+          .append('\t').append(s.getNumWaits())
+          .append('\t')
+          .append(toMs(s.getWaitNanos()))
+          .append('\t').append(s.getNumTimeouts())
+          .append('\t');
+        double hitRate = s.getPoolHitRate();
+        if (hitRate < 0.0) {
+          sb.append('-');
+        } else {
+          sb.append(String.format("%.3f", hitRate));
+        }
+        sb.append('\n');
+      }
+    }
+    ResourcePool pool = ResourcePool.get();
+    long hits = pool.getNumArrayHits();
+    long total = hits + pool.getNumArrayMisses();
+    sb.append("Array pool hits: ").append(hits)
+      .append(", requests: ").append(total)
+      .append(", held bytes: ")
+      .append(pool.getNumHeldBytes());
+    if (isTimelineEnabled) {
+      sb.append(", timeline events: ")
+        .append(numEvents.get())
+        .append(", dropped: ")
+        .append(numDroppedEvents.sum());
+    }
+    return sb.toString();
+  }
+
+  private static long toMs(long nanos) {
+    return nanos / 1000000L;
+  }
+
+  private static String toMB(long bytes) {
+    return String.format("%.3f",
+      bytes / 1048576.0);
+  }
+
+  /**
+   * Write the timeline in the Chrome trace event
+   * format. The timestamps are aligned to the
+   * wall clock, so the timelines of different
+   * workers can be loaded together.
+   * 
+   * @param out
+   *          the output stream, not closed
+   * @throws IOException
+   */
+  public void writeTimeline(OutputStream out)
+    throws IOException {
+    Writer writer =
+      new BufferedWriter(new OutputStreamWriter(
+        out, StandardCharsets.UTF_8));
+    writer.write("{\"traceEvents\":[\n");
+    writer.write("{\"name\":\"process_name\","
+      + "\"ph\":\"M\",\"pid\":" + workerID
+      + ",\"args\":{\"name\":\"worker "
+      + workerID + "\"}}");
+    for (TraceEvent event : events) {
+      writer.write(",\n{\"name\":");
+      writeString(writer, event.name);
+      writer.write(",\"cat\":");
+      writeString(writer, event.category);
+      writer.write(",\"ph\":\"X\",\"ts\":");
+      writer.write(
+        Long.toString(baseMicros + event.start
+          / 1000L));
+      writer.write(",\"dur\":");
+      writer.write(Long.toString(
+        (event.end - event.start) / 1000L));
+      writer.write(",\"pid\":");
+      writer.write(Integer.toString(workerID));
+      writer.write(",\"tid\":");
+      writer.write(Long.toString(event.threadID));
+      writer.write(",\"args\":{\"context\":");
+      writeString(writer, event.contextName);
+      writer.write(",\"operation\":");
+      writeString(writer, event.operationName);
+      if (event.bytes >= 0L) {
+        writer.write(",\"bytes\":");
+        writer.write(Long.toString(event.bytes));
+      }
+      writer.write("}}");
+    }
+    writer.write("\n]}\n");
+    writer.flush();
+  }
+
+  private static void writeString(Writer writer,
+    String str) throws IOException {
+    if (str == null) {
+      writer.write("null");
+      return;
+    }
+    writer.write('"');
+    for (int i = 0; i < str.length(); i++) {
+      char c = str.charAt(i);
+      if (c == '"' || c == '\\') {
+        writer.write('\\');
+        writer.write(c);
+      } else if (c < 0x20) {
+        writer.write(
+          String.format("\\u%04x", (int) c));
+      } else {
+        writer.write(c);
+      }
+    }
+    writer.write('"');
+  }
+
+  /**
+   * Clear the counters and the timeline
+   */
+  public void reset() {
+    stats.clear();
+    events.clear();
+    numEvents.set(0);
+    numDroppedEvents.reset();
+  }
+}
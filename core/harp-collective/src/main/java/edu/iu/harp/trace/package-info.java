@@ -0,0 +1,4 @@
+/**
+ * tracing and counters of the collective communication
+ */
+package edu.iu.harp.trace;
\ No newline at end of file
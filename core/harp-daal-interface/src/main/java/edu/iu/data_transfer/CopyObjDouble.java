@@ -20,11 +20,18 @@ public class CopyObjDouble
 {
 
   private double[] data;
+  private int offset;   //start of the vector in data
   private int index;
 
   public CopyObjDouble(double[] data, int index) 
+  {
+    this(data, 0, index);
+  }
+
+  public CopyObjDouble(double[] data, int offset, int index) 
   {
     this.data = data;
+    this.offset = offset;
     this.index = index;
   }
 
@@ -33,6 +40,11 @@ public class CopyObjDouble
       return this.data;
   }
 
+  public int offset()
+  {
+      return this.offset;
+  }
+
   public int index()
   {
       return this.index;
@@ -20,11 +20,18 @@ public class CopyObjFloat
 {
 
   private float[] data;
+  private int offset;   //start of the vector in data
   private int index;
 
   public CopyObjFloat(float[] data, int index) 
+  {
+    this(data, 0, index);
+  }
+
+  public CopyObjFloat(float[] data, int offset, int index) 
   {
     this.data = data;
+    this.offset = offset;
     this.index = index;
   }
 
@@ -33,6 +40,11 @@ public class CopyObjFloat
       return this.data;
   }
 
+  public int offset()
+  {
+      return this.offset;
+  }
+
   public int index()
   {
       return this.index;
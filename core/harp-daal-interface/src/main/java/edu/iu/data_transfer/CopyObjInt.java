@@ -20,11 +20,18 @@ public class CopyObjInt
 {
 
   private int[] data;
+  private int offset;   //start of the vector in data
   private int index;
 
   public CopyObjInt(int[] data, int index) 
+  {
+    this(data, 0, index);
+  }
+
+  public CopyObjInt(int[] data, int offset, int index) 
   {
     this.data = data;
+    this.offset = offset;
     this.index = index;
   }
 
@@ -33,6 +40,11 @@ public class CopyObjInt
       return this.data;
   }
 
+  public int offset()
+  {
+      return this.offset;
+  }
+
   public int index()
   {
       return this.index;
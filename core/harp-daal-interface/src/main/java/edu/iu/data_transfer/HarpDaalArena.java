@@ -0,0 +1,504 @@
+/*
+ * Copyright 2013-2016 Indiana University
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+package edu.iu.data_transfer;
+
+import com.intel.daal.data_management.data.HomogenNumericTable;
+import com.intel.daal.services.DaalContext;
+import edu.iu.harp.partition.Partition;
+import edu.iu.harp.partition.Table;
+import edu.iu.harp.resource.Array;
+import edu.iu.harp.resource.DoubleArray;
+import edu.iu.harp.resource.FloatArray;
+import edu.iu.harp.resource.IntArray;
+import it.unimi.dsi.fastutil.ints.Int2IntOpenHashMap;
+import org.apache.log4j.Logger;
+
+import java.util.ArrayList;
+import java.util.List;
+
+/**
+ * @brief A contiguous row-major array shared by the partitions
+ * of a Harp table and a DAAL HomogenNumericTable.
+ * Each partition is bound to a block of consecutive rows and
+ * its array is a view of these rows, the DAAL table wraps the
+ * whole array, so the data is converted without copy.
+ * The binding is the only mapping between partitions and DAAL
+ * rows, the copy paths use it as well
+ */
+public class HarpDaalArena {
+
+  private static final Logger LOG = Logger.getLogger(HarpDaalArena.class);
+
+  private Object arena;                     //double[], float[] or int[] of num_rows*vec_size
+  private int num_rows;                     //number of rows (vectors) in arena
+  private int vec_size;                     //dimension of vector in arena
+  private HomogenNumericTable daal_table;   //daal table wrapping arena
+
+  private Int2IntOpenHashMap row_map;       //partition id -> first row
+  private Int2IntOpenHashMap len_map;       //partition id -> number of rows
+  private int num_bound_rows;               //rows [0, num_bound_rows) are bound
+
+  private HarpDaalArena(Object arena,
+                        int num_rows,
+                        int vec_size,
+                        HomogenNumericTable daal_table) {
+
+      this.arena = arena;
+      this.num_rows = num_rows;
+      this.vec_size = vec_size;
+      this.daal_table = daal_table;
+
+      this.row_map = new Int2IntOpenHashMap();
+      this.row_map.defaultReturnValue(-1);
+      this.len_map = new Int2IntOpenHashMap();
+      this.num_bound_rows = 0;
+  }
+
+  /**
+   * @brief Allocate an arena of double precision
+   *
+   * @param context
+   * @param num_rows
+   * @param vec_size
+   *
+   * @return
+   */
+  public static HarpDaalArena allocateDouble(DaalContext context, int num_rows, int vec_size) {
+      double[] arena = new double[arenaLength(num_rows, vec_size)];
+      return new HarpDaalArena(arena, num_rows, vec_size,
+              new HomogenNumericTable(context, arena, vec_size, num_rows));
+  }
+
+  /**
+   * @brief Allocate an arena of float precision
+   *
+   * @param context
+   * @param num_rows
+   * @param vec_size
+   *
+   * @return
+   */
+  public static HarpDaalArena allocateFloat(DaalContext context, int num_rows, int vec_size) {
+      float[] arena = new float[arenaLength(num_rows, vec_size)];
+      return new HarpDaalArena(arena, num_rows, vec_size,
+              new HomogenNumericTable(context, arena, vec_size, num_rows));
+  }
+
+  /**
+   * @brief Allocate an arena of int value
+   *
+   * @param context
+   * @param num_rows
+   * @param vec_size
+   *
+   * @return
+   */
+  public static HarpDaalArena allocateInt(DaalContext context, int num_rows, int vec_size) {
+      int[] arena = new int[arenaLength(num_rows, vec_size)];
+      return new HarpDaalArena(arena, num_rows, vec_size,
+              new HomogenNumericTable(context, arena, vec_size, num_rows));
+  }
+
+  private static int arenaLength(int num_rows, int vec_size) {
+
+      long len = (long)num_rows*vec_size;
+      if (num_rows <= 0 || vec_size <= 0 || len > Integer.MAX_VALUE)
+          throw new IllegalArgumentException("Invalid arena size "
+                  + num_rows + " x " + vec_size);
+
+      return (int)len;
+  }
+
+  /**
+   * @brief Bind the next free rows to a partition.
+   * A bound partition keeps its rows, binding it again
+   * only checks the number of rows.
+   * Every mapper must bind the partitions in the same order
+   * to get the same DAAL rows
+   *
+   * @param partition_id
+   * @param rows
+   *
+   * @return the first row of the partition
+   */
+  public int bindRows(int partition_id, int rows) {
+
+      int row = row_map.get(partition_id);
+      if (row >= 0)
+      {
+          if (len_map.get(partition_id) != rows)
+              throw new IllegalArgumentException("Partition " + partition_id
+                      + " is bound to " + len_map.get(partition_id) + " rows, not " + rows);
+
+          return row;
+      }
+
+      if (rows <= 0 || rows > num_rows - num_bound_rows)
+          throw new IllegalArgumentException("No " + rows
+                  + " free rows in arena for partition " + partition_id);
+
+      row = num_bound_rows;
+      row_map.put(partition_id, row);
+      len_map.put(partition_id, rows);
+      num_bound_rows += rows;
+      return row;
+  }
+
+  /**
+   * @brief Get the first row of a partition
+   *
+   * @param partition_id
+   *
+   * @return the first row, -1 if the partition is not bound
+   */
+  public int rowOf(int partition_id) {
+      return row_map.get(partition_id);
+  }
+
+  /**
+   * @brief Get the number of rows of a partition
+   *
+   * @param partition_id
+   *
+   * @return the number of rows, 0 if the partition is not bound
+   */
+  public int numRowsOf(int partition_id) {
+      return len_map.get(partition_id);
+  }
+
+  /**
+   * @brief A view of the rows of a partition,
+   * used as the array of the partition
+   *
+   * @param partition_id
+   * @param rows
+   *
+   * @return
+   */
+  public DoubleArray doubleRows(int partition_id, int rows) {
+      int row = bindRows(partition_id, rows);
+      return new DoubleArray((double[])arena, row*vec_size, rows*vec_size);
+  }
+
+  /**
+   * @brief A view of the rows of a partition,
+   * used as the array of the partition
+   *
+   * @param partition_id
+   * @param rows
+   *
+   * @return
+   */
+  public FloatArray floatRows(int partition_id, int rows) {
+      int row = bindRows(partition_id, rows);
+      return new FloatArray((float[])arena, row*vec_size, rows*vec_size);
+  }
+
+  /**
+   * @brief A view of the rows of a partition,
+   * used as the array of the partition
+   *
+   * @param partition_id
+   * @param rows
+   *
+   * @return
+   */
+  public IntArray intRows(int partition_id, int rows) {
+      int row = bindRows(partition_id, rows);
+      return new IntArray((int[])arena, row*vec_size, rows*vec_size);
+  }
+
+  /**
+   * @brief Check if every partition of harp_table is the view
+   * of its bound rows and the partitions cover the arena.
+   * Then daal_table already holds the data of harp_table
+   *
+   * @param harp_table
+   *
+   * @return
+   */
+  public <E extends Array<?>> boolean isShared(Table<E> harp_table) {
+
+      if (num_bound_rows != num_rows
+              || harp_table.getNumPartitions() != row_map.size())
+          return false;
+
+      for(Partition<E> p : harp_table.getPartitions())
+      {
+          if (!isInPlace(p.id(), p.get()))
+              return false;
+      }
+
+      return true;
+  }
+
+  private boolean isInPlace(int partition_id, Array<?> array) {
+
+      int row = row_map.get(partition_id);
+      return (row >= 0 && array.get() == arena
+              && array.start() == row*vec_size
+              && array.size() == len_map.get(partition_id)*vec_size);
+  }
+
+  /**
+   * @brief Copy the partitions which are not views of their rows
+   * into the rows. Unbound partitions are bound to free rows first.
+   * Rows without a partition in harp_table keep their data
+   *
+   * @param harp_table
+   * @param num_threads
+   *
+   * @return
+   */
+  public <E extends Array<?>> void copyIn(Table<E> harp_table, int num_threads) {
+      copy(harp_table, num_threads, true, false);
+  }
+
+  /**
+   * @brief Copy the rows into the partitions which are not
+   * views of their rows. A partition viewing other rows of
+   * the arena gets a new array, so no other rows are written
+   *
+   * @param harp_table
+   * @param num_threads
+   *
+   * @return
+   */
+  public <E extends Array<?>> void copyOut(Table<E> harp_table, int num_threads) {
+      copy(harp_table, num_threads, false, false);
+  }
+
+  /**
+   * @brief Copy the partitions which are not views of their rows
+   * into the rows, then replace their arrays by the views and release
+   * the old arrays. Afterwards the table is shared if it covers the arena,
+   * e.g. after the partitions were received by a collective
+   *
+   * @param harp_table
+   * @param num_threads
+   *
+   * @return
+   */
+  public <E extends Array<?>> void adopt(Table<E> harp_table, int num_threads) {
+      copy(harp_table, num_threads, true, true);
+  }
+
+  @SuppressWarnings("unchecked")
+  private <E extends Array<?>> void copy(Table<E> harp_table, int num_threads,
+                                         boolean to_arena, boolean adopt) {
+
+      List<Partition<E>> moved = new ArrayList<>();
+      boolean misplaced = false;
+
+      for(Partition<E> p : harp_table.getPartitions())
+      {
+          Array<?> array = p.get();
+          if (isInPlace(p.id(), array))
+              continue;
+
+          if (array.size() % vec_size != 0)
+          {
+              LOG.error("Partition " + p.id() + " of size " + array.size()
+                      + " is not made of rows of " + vec_size);
+              continue;
+          }
+
+          int rows = array.size()/vec_size;
+          if (row_map.get(p.id()) < 0)
+          {
+              if (!to_arena || rows <= 0 || rows > num_rows - num_bound_rows)
+              {
+                  LOG.error("Partition " + p.id() + " has no rows in arena");
+                  continue;
+              }
+
+              bindRows(p.id(), rows);
+          }
+          else if (len_map.get(p.id()) != rows)
+          {
+              LOG.error("Partition " + p.id() + " has " + rows + " rows, "
+                      + len_map.get(p.id()) + " rows are bound");
+              continue;
+          }
+
+          if (to_arena && array.get() == arena)
+              misplaced = true;
+
+          moved.add(p);
+      }
+
+      if (moved.isEmpty())
+          return;
+
+      //a view of other rows overlaps the rows being written,
+      //so the arena is read from a snapshot
+      Object snapshot = misplaced ? cloneArena() : arena;
+
+      int task_num = moved.size();
+      Object[] srcs = new Object[task_num];
+      int[] src_offsets = new int[task_num];
+      Object[] dsts = new Object[task_num];
+      int[] dst_offsets = new int[task_num];
+      int[] lengths = new int[task_num];
+      Array<?>[] detached = new Array<?>[task_num];
+
+      for (int i = 0; i < task_num; i++)
+      {
+          Array<?> array = moved.get(i).get();
+          int row_start = row_map.get(moved.get(i).id())*vec_size;
+          if (to_arena)
+          {
+              srcs[i] = (array.get() == arena) ? snapshot : array.get();
+              src_offsets[i] = array.start();
+              dsts[i] = arena;
+              dst_offsets[i] = row_start;
+          }
+          else if (array.get() == arena)
+          {
+              //writing through a view of other rows would overwrite
+              //them, the partition is given a new array instead
+              detached[i] = newArray(array.size());
+              srcs[i] = arena;
+              src_offsets[i] = row_start;
+              dsts[i] = detached[i].get();
+              dst_offsets[i] = 0;
+          }
+          else
+          {
+              srcs[i] = arena;
+              src_offsets[i] = row_start;
+              dsts[i] = array.get();
+              dst_offsets[i] = array.start();
+          }
+          lengths[i] = array.size();
+      }
+
+      //multi-threading copy
+      Thread[] threads = new Thread[num_threads];
+
+      for (int q = 0; q<num_threads; q++)
+      {
+          threads[q] = new Thread(new TaskArenaCopy(q, num_threads, task_num, srcs, src_offsets, dsts, dst_offsets, lengths));
+          threads[q].start();
+      }
+
+      for (int q = 0; q< num_threads; q++) {
+
+          try
+          {
+              threads[q].join();
+
+          }catch(InterruptedException e)
+          {
+              System.out.println("Thread interrupted.");
+          }
+
+      }
+
+      for (int i = 0; i < task_num; i++)
+      {
+          if (detached[i] != null)
+          {
+              int partition_id = moved.get(i).id();
+              harp_table.removePartition(partition_id);
+              harp_table.addPartition(new Partition<>(partition_id,
+                      (E)detached[i]));
+          }
+      }
+
+      if (adopt)
+      {
+          for(Partition<E> p : moved)
+          {
+              int partition_id = p.id();
+              harp_table.removePartition(partition_id);
+              p.release();
+              harp_table.addPartition(new Partition<>(partition_id,
+                      (E)view(partition_id)));
+          }
+      }
+  }
+
+  private Array<?> view(int partition_id) {
+
+      int start = row_map.get(partition_id)*vec_size;
+      int size = len_map.get(partition_id)*vec_size;
+      if (arena instanceof double[])
+          return new DoubleArray((double[])arena, start, size);
+      else if (arena instanceof float[])
+          return new FloatArray((float[])arena, start, size);
+      else
+          return new IntArray((int[])arena, start, size);
+  }
+
+  private Array<?> newArray(int size) {
+
+      if (arena instanceof double[])
+          return new DoubleArray(new double[size], 0, size);
+      else if (arena instanceof float[])
+          return new FloatArray(new float[size], 0, size);
+      else
+          return new IntArray(new int[size], 0, size);
+  }
+
+  private Object cloneArena() {
+
+      if (arena instanceof double[])
+          return ((double[])arena).clone();
+      else if (arena instanceof float[])
+          return ((float[])arena).clone();
+      else
+          return ((int[])arena).clone();
+  }
+
+  /**
+   * @brief Accessor to the arena array
+   *
+   * @return
+   */
+  public Object arena() {
+      return this.arena;
+  }
+
+  /**
+   * @brief Accessor to the daal table wrapping the arena
+   *
+   * @return
+   */
+  public HomogenNumericTable daal_table() {
+      return this.daal_table;
+  }
+
+  /**
+   * @brief Accessor to the number of rows
+   *
+   * @return
+   */
+  public int num_rows() {
+      return this.num_rows;
+  }
+
+  /**
+   * @brief Accessor to the dimension of vector
+   *
+   * @return
+   */
+  public int vec_size() {
+      return this.vec_size;
+  }
+
+}
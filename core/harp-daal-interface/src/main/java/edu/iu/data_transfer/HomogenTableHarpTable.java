@@ -58,6 +58,8 @@ public class HomogenTableHarpTable<I, E extends Array<I>, T extends Table<E> > {
   private CopyObjFloat[] obj_list_float;    //obj list for copying float data
   private CopyObjInt[] obj_list_int;        //obj list for copying int data
 
+  private HarpDaalArena arena;              //arena shared by harp_table and daal_table, or null
+
   /**
    * @brief Constructor 
    *
@@ -89,6 +91,30 @@ public class HomogenTableHarpTable<I, E extends Array<I>, T extends Table<E> > {
       this.obj_list_float = null;
       this.obj_list_int = null;
 
+      this.arena = null;
+
+  }
+
+  /**
+   * @brief Constructor for a harp table whose partitions are
+   * bound to rows of arena, the daal table is the one wrapping arena.
+   * The conversions copy nothing for the partitions which are views
+   * of their rows, and copy the others between the partition and
+   * its rows, so the DAAL row of a partition never changes
+   *
+   * @param harp_table
+   * @param arena
+   * @param num_threads
+   *
+   * @return 
+   */
+  public HomogenTableHarpTable(T harp_table, 
+                               HarpDaalArena arena, 
+                               int num_threads) {
+
+      this(harp_table, arena.daal_table(), arena.num_rows(), 
+           arena.vec_size(), num_threads);
+      this.arena = arena;
   }
 
   /**
@@ -109,6 +135,15 @@ public class HomogenTableHarpTable<I, E extends Array<I>, T extends Table<E> > {
       return this.daal_table;
   }
 
+  /**
+   * @brief Accessor to the arena
+   *
+   * @return 
+   */
+  public HarpDaalArena arena() {
+      return this.arena;
+  }
+
   /**
    * @brief Accessor to the obj_list_double
    *
@@ -170,6 +205,14 @@ public class HomogenTableHarpTable<I, E extends Array<I>, T extends Table<E> > {
    * @return 
    */
   public void HarpToDaalDouble() {//{{{
+
+      //partitions are views of their rows in the daal table,
+      //only the others are copied
+      if (arena != null)
+      {
+          arena.copyIn(harp_table, num_threads);
+          return;
+      }
         
       if (buffer_array_double == null)
         buffer_array_double = new double[table_size*vec_size];
@@ -182,7 +225,7 @@ public class HomogenTableHarpTable<I, E extends Array<I>, T extends Table<E> > {
           for(Partition<E> p : harp_table.getPartitions())
           {
               double[] data = (double[])p.get().get(); 
-              obj_list_double[table_entry] = new CopyObjDouble(data, table_entry);
+              obj_list_double[table_entry] = new CopyObjDouble(data, p.get().start(), table_entry);
               table_entry++;
           }
 
@@ -225,6 +268,14 @@ public class HomogenTableHarpTable<I, E extends Array<I>, T extends Table<E> > {
    */
   public void DaalToHarpDouble() {//{{{
 
+      //partitions are views of their rows in the daal table,
+      //only the others are copied
+      if (arena != null)
+      {
+          arena.copyOut(harp_table, num_threads);
+          return;
+      }
+
       if (buffer_array_double == null)
         buffer_array_double = new double[table_size*vec_size];
 
@@ -236,7 +287,7 @@ public class HomogenTableHarpTable<I, E extends Array<I>, T extends Table<E> > {
           for(Partition<E> p : harp_table.getPartitions())
           {
               double[] data = (double[])p.get().get(); 
-              obj_list_double[table_entry] = new CopyObjDouble(data, table_entry);
+              obj_list_double[table_entry] = new CopyObjDouble(data, p.get().start(), table_entry);
               table_entry++;
           }
 
@@ -283,6 +334,14 @@ public class HomogenTableHarpTable<I, E extends Array<I>, T extends Table<E> > {
    */
   public void HarpToDaalFloat() {//{{{
 
+      //partitions are views of their rows in the daal table,
+      //only the others are copied
+      if (arena != null)
+      {
+          arena.copyIn(harp_table, num_threads);
+          return;
+      }
+
       if (buffer_array_float == null)
         buffer_array_float = new float[table_size*vec_size];
       
@@ -294,7 +353,7 @@ public class HomogenTableHarpTable<I, E extends Array<I>, T extends Table<E> > {
           for(Partition<E> p : harp_table.getPartitions())
           {
               float[] data = (float[])p.get().get(); 
-              obj_list_float[table_entry] = new CopyObjFloat(data, table_entry);
+              obj_list_float[table_entry] = new CopyObjFloat(data, p.get().start(), table_entry);
               table_entry++;
           }
 
@@ -338,6 +397,14 @@ public class HomogenTableHarpTable<I, E extends Array<I>, T extends Table<E> > {
    */
   public void DaalToHarpFloat() {//{{{
 
+      //partitions are views of their rows in the daal table,
+      //only the others are copied
+      if (arena != null)
+      {
+          arena.copyOut(harp_table, num_threads);
+          return;
+      }
+
       if (buffer_array_float == null)
         buffer_array_float = new float[table_size*vec_size];
       
@@ -349,7 +416,7 @@ public class HomogenTableHarpTable<I, E extends Array<I>, T extends Table<E> > {
           for(Partition<E> p : harp_table.getPartitions())
           {
               float[] data = (float[])p.get().get(); 
-              obj_list_float[table_entry] = new CopyObjFloat(data, table_entry);
+              obj_list_float[table_entry] = new CopyObjFloat(data, p.get().start(), table_entry);
               table_entry++;
           }
 
@@ -393,6 +460,14 @@ public class HomogenTableHarpTable<I, E extends Array<I>, T extends Table<E> > {
    */
   public void HarpToDaalInt() {//{{{
 
+      //partitions are views of their rows in the daal table,
+      //only the others are copied
+      if (arena != null)
+      {
+          arena.copyIn(harp_table, num_threads);
+          return;
+      }
+
       if (buffer_array_int == null)
         buffer_array_int = new int[table_size*vec_size];
       
@@ -404,7 +479,7 @@ public class HomogenTableHarpTable<I, E extends Array<I>, T extends Table<E> > {
           for(Partition<E> p : harp_table.getPartitions())
           {
               int[] data = (int[])p.get().get(); 
-              obj_list_int[table_entry] = new CopyObjInt(data, table_entry);
+              obj_list_int[table_entry] = new CopyObjInt(data, p.get().start(), table_entry);
               table_entry++;
           }
 
@@ -447,6 +522,14 @@ public class HomogenTableHarpTable<I, E extends Array<I>, T extends Table<E> > {
    */
   public void DaalToHarpInt() {//{{{
 
+      //partitions are views of their rows in the daal table,
+      //only the others are copied
+      if (arena != null)
+      {
+          arena.copyOut(harp_table, num_threads);
+          return;
+      }
+
       if (buffer_array_int == null)
         buffer_array_int = new int[table_size*vec_size];
       
@@ -458,7 +541,7 @@ public class HomogenTableHarpTable<I, E extends Array<I>, T extends Table<E> > {
           for(Partition<E> p : harp_table.getPartitions())
           {
               int[] data = (int[])p.get().get(); 
-              obj_list_int[table_entry] = new CopyObjInt(data, table_entry);
+              obj_list_int[table_entry] = new CopyObjInt(data, p.get().start(), table_entry);
               table_entry++;
           }
 
@@ -44,6 +44,7 @@ public class RotatorDaal<I, P extends Array<I> > {
   private NumericTable daal_table;                      // daal_table to hold H Table 
   private List<RotateTaskDaal<I, P> > rotateTasks;
   private StaticScheduler<Integer, NumericTable, RotateTaskDaal<I, P> > rotation;
+  private long exposedTime;                             // time blocked waiting for rotations
 
   public RotatorDaal(Table<P>[] tableMap,
     int rdim, int numThreads, CollectiveMapper<?, ?, ?, ?> mapper,
@@ -59,6 +60,7 @@ public class RotatorDaal<I, P extends Array<I> > {
     }
 
     rotation = new StaticScheduler<>(rotateTasks);
+    this.exposedTime = 0L;
 
   }
 
@@ -83,7 +85,9 @@ public class RotatorDaal<I, P extends Array<I> > {
 
     //taskID is the id of H model slices
     if (rotation.hasOutput(taskID)) {
+      long t1 = System.currentTimeMillis();
       daal_table = rotation.waitForOutput(taskID);
+      exposedTime += System.currentTimeMillis() - t1;
     } else {
       LOG.info("No task rotation output !!!");
       daal_table = rotation.getTask(taskID).daal_table();
@@ -103,6 +107,18 @@ public class RotatorDaal<I, P extends Array<I> > {
     rotation.submit(taskID, 1);
   }
 
+  /**
+   * @brief get and reset the rotation time
+   * not hidden behind computation
+   *
+   * @return the exposed rotation time in milliseconds
+   */
+  public long resetExposedTime() {
+    long time = this.exposedTime;
+    this.exposedTime = 0L;
+    return time;
+  }
+
   public void start() {
     rotation.start();
   }
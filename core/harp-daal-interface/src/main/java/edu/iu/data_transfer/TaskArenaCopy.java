@@ -0,0 +1,67 @@
+/*
+ * Copyright 2013-2016 Indiana University
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * */
+
+package edu.iu.data_transfer;
+
+import java.lang.System;
+
+public class TaskArenaCopy implements Runnable {
+
+    private int th_id;
+    private int th_num;
+    private int task_num;
+    private Object[] srcs;          //double[], float[] or int[]
+    private int[] src_offsets;
+    private Object[] dsts;          //arrays of the same type as srcs
+    private int[] dst_offsets;
+    private int[] lengths;
+
+    //constructor
+    TaskArenaCopy(
+            int th_id,
+            int th_num,
+            int task_num,
+            Object[] srcs,
+            int[] src_offsets,
+            Object[] dsts,
+            int[] dst_offsets,
+            int[] lengths
+    )
+    {
+        this.th_id = th_id;
+        this.th_num = th_num;
+        this.task_num = task_num;
+        this.srcs = srcs;
+        this.src_offsets = src_offsets;
+        this.dsts = dsts;
+        this.dst_offsets = dst_offsets;
+        this.lengths = lengths;
+    }
+
+    @Override
+    public void run() {
+
+        while(th_id < task_num)
+        {
+            System.arraycopy(srcs[th_id], src_offsets[th_id], dsts[th_id], dst_offsets[th_id], lengths[th_id]);
+            th_id += th_num;
+        }
+
+    }
+
+
+}
@@ -52,7 +52,7 @@ public class TaskBufferToTableDouble implements Runnable {
         while(th_id < task_num)
         {
             CopyObjDouble obj = queue[th_id];
-            System.arraycopy(buffer_array, obj.index()*vecsize, obj.data(), 0, vecsize); 
+            System.arraycopy(buffer_array, obj.index()*vecsize, obj.data(), obj.offset(), vecsize); 
             th_id += th_num;
         }
 
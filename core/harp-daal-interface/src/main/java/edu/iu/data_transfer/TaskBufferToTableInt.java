@@ -53,7 +53,7 @@ public class TaskBufferToTableInt implements Runnable {
         {
             CopyObjInt obj = queue[th_id];
             // System.arraycopy(obj.data(), 0, buffer_array, obj.index()*vecsize, vecsize); 
-            System.arraycopy(buffer_array, obj.index()*vecsize, obj.data(), 0, vecsize); 
+            System.arraycopy(buffer_array, obj.index()*vecsize, obj.data(), obj.offset(), vecsize); 
             th_id += th_num;
         }
 
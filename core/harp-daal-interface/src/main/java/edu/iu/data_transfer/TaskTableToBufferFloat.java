@@ -52,7 +52,7 @@ public class TaskTableToBufferFloat implements Runnable {
         while(th_id < task_num)
         {
             CopyObjFloat obj = queue[th_id];
-            System.arraycopy(obj.data(), 0, buffer_array, obj.index()*vecsize, vecsize); 
+            System.arraycopy(obj.data(), obj.offset(), buffer_array, obj.index()*vecsize, vecsize); 
             th_id += th_num;
         }
 
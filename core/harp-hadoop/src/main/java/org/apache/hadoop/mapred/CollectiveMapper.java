@@ -21,25 +21,31 @@ import edu.iu.harp.client.EventType;
 import edu.iu.harp.client.SyncClient;
 import edu.iu.harp.collective.AllgatherCollective;
 import edu.iu.harp.collective.AllreduceCollective;
+import edu.iu.harp.collective.AllreduceMode;
 import edu.iu.harp.collective.BcastCollective;
 import edu.iu.harp.collective.Communication;
 import edu.iu.harp.collective.LocalGlobalSyncCollective;
 import edu.iu.harp.collective.ReduceCollective;
 import edu.iu.harp.collective.RegroupCollective;
+import edu.iu.harp.collective.RotateHandle;
+import edu.iu.harp.collective.RotationPipeline;
 import edu.iu.harp.io.ConnPool;
 import edu.iu.harp.io.Constant;
 import edu.iu.harp.io.DataMap;
 import edu.iu.harp.io.EventQueue;
+import edu.iu.harp.io.WireEncoding;
 import edu.iu.harp.partition.Partitioner;
 import edu.iu.harp.partition.Table;
 import edu.iu.harp.resource.ResourcePool;
 import edu.iu.harp.resource.Simple;
 import edu.iu.harp.server.Server;
+import edu.iu.harp.trace.Tracer;
 import edu.iu.harp.worker.Workers;
 import it.unimi.dsi.fastutil.ints.Int2IntMap;
 import org.apache.commons.logging.Log;
 import org.apache.commons.logging.LogFactory;
 import org.apache.hadoop.fs.FSDataInputStream;
+import org.apache.hadoop.fs.FSDataOutputStream;
 import org.apache.hadoop.fs.FileSystem;
 import org.apache.hadoop.fs.Path;
 import org.apache.hadoop.mapreduce.Mapper;
@@ -75,6 +81,34 @@ public class CollectiveMapper<KEYIN, VALUEIN, KEYOUT, VALUEOUT>
   protected static final Log LOG =
     LogFactory.getLog(CollectiveMapper.class);
 
+  /**
+   * The maximum number of bytes held by the free
+   * arrays in each array pool
+   */
+  public static final String POOL_MAX_HELD_BYTES =
+    "mapreduce.map.collective.pool.max.held.bytes";
+  /** If NIO channels are used for transport */
+  public static final String USE_NIO =
+    "mapreduce.map.collective.nio";
+  /**
+   * If the sparse and compressed encodings are
+   * used for the data sent by this worker
+   */
+  public static final String WIRE_ENCODING =
+    "mapreduce.map.collective.wire.encoding";
+  /**
+   * If the timeline of the collective
+   * communication is recorded
+   */
+  public static final String TRACE_TIMELINE =
+    "mapreduce.map.collective.trace.timeline";
+  /**
+   * The directory of the timelines, relative to
+   * the home directory if not absolute
+   */
+  public static final String TRACE_DIR =
+    "mapreduce.map.collective.trace.dir";
+
   private int workerID;
   private Workers workers;
   private EventQueue eventQueue;
@@ -287,6 +321,19 @@ public class CollectiveMapper<KEYIN, VALUEIN, KEYOUT, VALUEOUT>
       LOG.error("Cannot initialize workers.", e);
       throw new IOException(e);
     }
+    long maxHeldBytes = context.getConfiguration()
+      .getLong(POOL_MAX_HELD_BYTES, Long.MAX_VALUE);
+    ResourcePool.get().setMaxHeldBytes(maxHeldBytes);
+    boolean useNIO = context.getConfiguration()
+      .getBoolean(USE_NIO, false);
+    ConnPool.get().setUseNIO(useNIO);
+    WireEncoding.setEnabled(context
+      .getConfiguration()
+      .getBoolean(WIRE_ENCODING, false));
+    Tracer.get().setWorkerID(workerID);
+    Tracer.get().setTimelineEnabled(
+      context.getConfiguration()
+        .getBoolean(TRACE_TIMELINE, false));
     eventQueue = new EventQueue();
     dataMap = new DataMap();
     client = new SyncClient(workers);
@@ -295,7 +342,7 @@ public class CollectiveMapper<KEYIN, VALUEIN, KEYOUT, VALUEOUT>
     int port = workers.getSelfInfo().getPort();
     try {
       server = new Server(host, port, eventQueue,
-        dataMap, workers);
+        dataMap, workers, useNIO);
     } catch (Exception e) {
       LOG.error("Cannot initialize receivers.",
         e);
@@ -405,10 +452,11 @@ public class CollectiveMapper<KEYIN, VALUEIN, KEYOUT, VALUEOUT>
     String contextName, String operationName,
     Table<P> table, int bcastWorkerID,
     boolean useMSTBcast) {
-    boolean isSucess =
-      BcastCollective.broadcast(contextName,
+    boolean isSucess = Tracer.get().traceOp(
+      contextName, operationName, "broadcast",
+      () -> BcastCollective.broadcast(contextName,
         operationName, table, bcastWorkerID,
-        useMSTBcast, dataMap, workers);
+        useMSTBcast, dataMap, workers));
     dataMap.cleanOperationData(contextName,
       operationName);
     return isSucess;
@@ -432,9 +480,11 @@ public class CollectiveMapper<KEYIN, VALUEIN, KEYOUT, VALUEOUT>
   public <P extends Simple> boolean reduce(
     String contextName, String operationName,
     Table<P> table, int reduceWorkerID) {
-    boolean isSuccess = ReduceCollective.reduce(
-      contextName, operationName, table,
-      reduceWorkerID, dataMap, workers);
+    boolean isSuccess = Tracer.get().traceOp(
+      contextName, operationName, "reduce",
+      () -> ReduceCollective.reduce(contextName,
+        operationName, table, reduceWorkerID,
+        dataMap, workers));
     dataMap.cleanOperationData(contextName,
       operationName);
     return isSuccess;
@@ -456,9 +506,11 @@ public class CollectiveMapper<KEYIN, VALUEIN, KEYOUT, VALUEOUT>
   public <P extends Simple> boolean allgather(
     String contextName, String operationName,
     Table<P> table) {
-    boolean isSuccess =
-      AllgatherCollective.allgather(contextName,
-        operationName, table, dataMap, workers);
+    boolean isSuccess = Tracer.get().traceOp(
+      contextName, operationName, "allgather",
+      () -> AllgatherCollective.allgather(
+        contextName, operationName, table,
+        dataMap, workers));
     dataMap.cleanOperationData(contextName,
       operationName);
     return isSuccess;
@@ -480,9 +532,42 @@ public class CollectiveMapper<KEYIN, VALUEIN, KEYOUT, VALUEOUT>
   public <P extends Simple> boolean allreduce(
     String contextName, String operationName,
     Table<P> table) {
-    boolean isSuccess =
-      AllreduceCollective.allreduce(contextName,
-        operationName, table, dataMap, workers);
+    boolean isSuccess = Tracer.get().traceOp(
+      contextName, operationName, "allreduce",
+      () -> AllreduceCollective.allreduce(
+        contextName, operationName, table,
+        dataMap, workers));
+    dataMap.cleanOperationData(contextName,
+      operationName);
+    return isSuccess;
+  }
+
+  /**
+   * Allreduce partitions of the tables to all the
+   * local tables with the given algorithm.
+   * 
+   * @param contextName
+   *          the name of the operation context
+   * @param operationName
+   *          the name of the operation
+   * @param table
+   *          the table to hold the partitions
+   * @param mode
+   *          the allreduce algorithm, AUTO
+   *          lets the workers agree on one from
+   *          the total table size and the number
+   *          of workers
+   * @return a boolean tells if the operation
+   *         succeeds
+   */
+  public <P extends Simple> boolean allreduce(
+    String contextName, String operationName,
+    Table<P> table, AllreduceMode mode) {
+    boolean isSuccess = Tracer.get().traceOp(
+      contextName, operationName, "allreduce",
+      () -> AllreduceCollective.allreduce(
+        contextName, operationName, table,
+        dataMap, workers, mode));
     dataMap.cleanOperationData(contextName,
       operationName);
     return isSuccess;
@@ -507,9 +592,11 @@ public class CollectiveMapper<KEYIN, VALUEIN, KEYOUT, VALUEOUT>
     boolean regroup(String contextName,
       String operationName, Table<P> table,
       PT partitioner) {
-    boolean isSucess = RegroupCollective
-      .regroupCombine(contextName, operationName,
-        table, partitioner, dataMap, workers);
+    boolean isSucess = Tracer.get().traceOp(
+      contextName, operationName, "regroup",
+      () -> RegroupCollective.regroupCombine(
+        contextName, operationName, table,
+        partitioner, dataMap, workers));
     dataMap.cleanOperationData(contextName,
       operationName);
     return isSucess;
@@ -540,10 +627,11 @@ public class CollectiveMapper<KEYIN, VALUEIN, KEYOUT, VALUEOUT>
     String contextName, String operationName,
     Table<P> localTable, Table<P> globalTable,
     boolean useBcast) {
-    boolean isSuccess =
-      LocalGlobalSyncCollective.pull(contextName,
-        operationName, localTable, globalTable,
-        useBcast, dataMap, workers);
+    boolean isSuccess = Tracer.get().traceOp(
+      contextName, operationName, "pull",
+      () -> LocalGlobalSyncCollective.pull(
+        contextName, operationName, localTable,
+        globalTable, useBcast, dataMap, workers));
     dataMap.cleanOperationData(contextName,
       operationName);
     return isSuccess;
@@ -575,10 +663,12 @@ public class CollectiveMapper<KEYIN, VALUEIN, KEYOUT, VALUEOUT>
     boolean push(String contextName,
       String operationName, Table<P> localTable,
       Table<P> globalTable, PT partitioner) {
-    boolean isSuccess =
-      LocalGlobalSyncCollective.push(contextName,
-        operationName, localTable, globalTable,
-        partitioner, dataMap, workers);
+    boolean isSuccess = Tracer.get().traceOp(
+      contextName, operationName, "push",
+      () -> LocalGlobalSyncCollective.push(
+        contextName, operationName, localTable,
+        globalTable, partitioner, dataMap,
+        workers));
     dataMap.cleanOperationData(contextName,
       operationName);
     return isSuccess;
@@ -607,14 +697,62 @@ public class CollectiveMapper<KEYIN, VALUEIN, KEYOUT, VALUEOUT>
   public <P extends Simple> boolean rotate(
     String contextName, String operationName,
     Table<P> globalTable, Int2IntMap rotateMap) {
-    boolean isSuccess = LocalGlobalSyncCollective
-      .rotate(contextName, operationName,
-        globalTable, rotateMap, dataMap, workers);
+    boolean isSuccess = Tracer.get().traceOp(
+      contextName, operationName, "rotate",
+      () -> LocalGlobalSyncCollective.rotate(
+        contextName, operationName, globalTable,
+        rotateMap, dataMap, workers));
     dataMap.cleanOperationData(contextName,
       operationName);
     return isSuccess;
   }
 
+  /**
+   * Start the rotation in the background. The
+   * global table must not be accessed until the
+   * returned handle completes, so computation on
+   * other tables can overlap the communication.
+   * 
+   * @param contextName
+   *          the name of the operation context
+   * @param operationName
+   *          the name of operation
+   * @param globalTable
+   *          the global table which acts like a
+   *          distributed dataset, each partition
+   *          in this table is unique
+   * @param rotateMap
+   *          the map from worker to worker,
+   *          defines how to rotate the data
+   * @return the handle of the rotation
+   */
+  public <P extends Simple> RotateHandle
+    rotateAsync(String contextName,
+      String operationName, Table<P> globalTable,
+      Int2IntMap rotateMap) {
+    return LocalGlobalSyncCollective.rotateAsync(
+      contextName, operationName, globalTable,
+      rotateMap, dataMap, workers);
+  }
+
+  /**
+   * Create a double-buffered rotation pipeline
+   * over the slices of a model
+   * 
+   * @param contextName
+   *          the name of the operation context
+   * @param slices
+   *          the model slices, each rotated as a
+   *          global table
+   * @return the rotation pipeline
+   */
+  public <P extends Simple> RotationPipeline<P>
+    createRotationPipeline(String contextName,
+      Table<P>[] slices) {
+    return new RotationPipeline<>(contextName,
+      slices, dataMap, workers);
+  }
+
   /**
    * Get an event from the event queue.
    * 
@@ -741,6 +879,36 @@ public class CollectiveMapper<KEYIN, VALUEIN, KEYOUT, VALUEOUT>
     // NOTHING
   }
 
+  /**
+   * Write the timeline of this worker to the
+   * trace directory if the timeline is enabled
+   * 
+   * @param context
+   *          the context
+   */
+  private void writeTimeline(Context context) {
+    if (!Tracer.get().isTimelineEnabled()) {
+      return;
+    }
+    String traceDir = context.getConfiguration()
+      .get(TRACE_DIR, context.getJobID().toString()
+        + "/trace");
+    try {
+      FileSystem fs =
+        FileSystem.get(context.getConfiguration());
+      Path path = new Path(
+        new Path(fs.getHomeDirectory(), traceDir),
+        "trace-worker-" + workerID + ".json");
+      try (FSDataOutputStream out =
+        fs.create(path, true)) {
+        Tracer.get().writeTimeline(out);
+      }
+      LOG.info("Write the timeline to " + path);
+    } catch (IOException e) {
+      LOG.error("Fail to write the timeline.", e);
+    }
+  }
+
   /**
    * Override this method to support collective
    * communications among Mappers
@@ -776,6 +944,8 @@ public class CollectiveMapper<KEYIN, VALUEIN, KEYOUT, VALUEOUT>
       mapCollective(reader, context);
       ResourcePool.get().log();
       ConnPool.get().log();
+      LOG.info(Tracer.get().getSummary());
+      writeTimeline(context);
     } catch (Throwable t) {
       LOG.error("Fail to do map-collective.", t);
       throw new IOException(t);
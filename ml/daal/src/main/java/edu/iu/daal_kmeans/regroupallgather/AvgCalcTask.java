@@ -26,38 +26,53 @@ import edu.iu.harp.partition.Table;
 import edu.iu.harp.resource.DoubleArray;
 
 public class AvgCalcTask implements
-  Task<DoubleArray, Object> {
+  Task<Partition<DoubleArray>, Object> {
 
   protected static final Log LOG = LogFactory
     .getLog(AvgCalcTask.class);
 
-  private final int cenVecSize;
+  private final int vectorSize;
+  private final Table<DoubleArray> countTable;
 
-  public AvgCalcTask(int cenVecSize) 
+  public AvgCalcTask(int vectorSize, Table<DoubleArray> countTable) 
   {
-        this.cenVecSize = cenVecSize;
+        this.vectorSize = vectorSize;
+        this.countTable = countTable;
   }
 
   /**
    * @brief compute the average values for 
    * each entrie of centroids vectors
-   * sentinel element stores the total counts 
+   * the partition of the same id in countTable 
+   * stores the total counts 
    *
-   * @param points
+   * @param partition
    *
    * @return 
    */
   @Override
-  public Object run(DoubleArray points) throws Exception {
+  public Object run(Partition<DoubleArray> partition) throws Exception {
 
-      double[] doubles = points.get();
-      int size = points.size();
-      for (int j = 0; j < size; j += cenVecSize) 
+      Partition<DoubleArray> countPartition = countTable.getPartition(partition.id());
+      if (countPartition == null)
       {
-          if (doubles[j] != 0) 
+          LOG.error("No counts of centroids partition " + partition.id());
+          return null;
+      }
+
+      double[] doubles = partition.get().get();
+      int start = partition.get().start();
+      int numCen = partition.get().size() / vectorSize;
+      double[] counts = countPartition.get().get();
+      int countStart = countPartition.get().start();
+      for (int j = 0; j < numCen; j++) 
+      {
+          double count = counts[countStart + j];
+          if (count != 0) 
           {
-              for (int k = 1; k < cenVecSize; k++) {
-                  doubles[j + k] /= doubles[j];
+              int offset = start + j * vectorSize;
+              for (int k = 0; k < vectorSize; k++) {
+                  doubles[offset + k] /= count;
               }
           }
 
@@ -218,7 +218,7 @@ public class KMUtil {
 
   public static void storeCentroids(
     Configuration configuration, String cenDir,
-    Table<DoubleArray> cenTable, int cenVecSize,
+    Table<DoubleArray> cenTable, int vectorSize,
     String name) throws IOException {
     String cFile =
       cenDir + File.separator + "out"
@@ -240,16 +240,15 @@ public class KMUtil {
     for (int i = 0; i < idArray.length; i++) {
       Partition<DoubleArray> partition =
         cenTable.getPartition(idArray[i]);
+      double[] cData = partition.get().get();
+      int start = partition.get().start();
       for (int j = 0; j < partition.get().size(); j++) {
-        linePos = j % cenVecSize;
-        if (linePos == (cenVecSize - 1)) {
-          bw.write(partition.get().get()[j]
-            + "\n");
-        } else if (linePos > 0) {
-          // Every row with vectorSize + 1 length,
-          // the first one is a count,
-          // ignore it in output
-          bw.write(partition.get().get()[j] + " ");
+        // Every row with vectorSize length
+        linePos = j % vectorSize;
+        if (linePos == (vectorSize - 1)) {
+          bw.write(cData[start + j] + "\n");
+        } else {
+          bw.write(cData[start + j] + " ");
         }
       }
     }
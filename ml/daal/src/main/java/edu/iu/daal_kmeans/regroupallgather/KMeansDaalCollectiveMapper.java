@@ -60,7 +60,6 @@ public class KMeansDaalCollectiveMapper
         private int numCentroids;
         private int vectorSize;
         private int numCenPars;
-        private int cenVecSize;
         private int numMappers;
         private int numThreads;
         private int numIterations;
@@ -68,12 +67,10 @@ public class KMeansDaalCollectiveMapper
 		private List<String> fileNames;
         private String cenDir;
 
-		private long[] array_startP_cen;
-        private long[] sentinel_startP_cen;
-        private double[][] array_data_cen;
-
-		private double[] buffer_array_cen;
+		private HarpDaalArena cen_arena;    //centroids shared by harp and daal
+		private Table<DoubleArray> cntTable = null;
 		private Table<DoubleArray> pushpullGlobal = null;
+		private Table<DoubleArray> pushpullGlobalCnt = null;
 
 
         //to measure the time
@@ -105,7 +102,6 @@ public class KMeansDaalCollectiveMapper
         numMappers =
             configuration.getInt(Constants.NUM_MAPPERS,
                     10);
-        cenVecSize = vectorSize + 1;
         numThreads =
             configuration.getInt(Constants.NUM_THREADS,
                     10);
@@ -168,9 +164,10 @@ public class KMeansDaalCollectiveMapper
 			List<double[]> pointArrays = LoadTrainingData();
 
 			// ---------- load in centroids (model) data ----------
-			// create a table to hold centroids data
+			// create a table to hold centroids data, its partitions are
+			// views of the rows of the daal centroids table
 			Table<DoubleArray> cenTable = new Table<>(0, new DoubleArrPlus());
-            //
+			createCenArena();
 			if (this.isMaster()) 
 			{
 				createCenTable(cenTable);
@@ -178,6 +175,7 @@ public class KMeansDaalCollectiveMapper
 			}
 			// Bcast centroids to other mappers
 			bcastCentroids(cenTable, this.getMasterID());
+			cen_arena.adopt(cenTable, this.numThreads);
 			// convert training data fro harp to daal
 			NumericTable trainingdata_daal = convertTrainData(pointArrays);
 			// create a daal kmeans kernel object
@@ -186,15 +184,18 @@ public class KMeansDaalCollectiveMapper
 			kmeansLocal.input.set(InputId.data, trainingdata_daal);
 			// specify the threads used in DAAL kernel
 			Environment.setNumberOfThreads(numThreads);
-			// create cenTable at daal side
-			NumericTable cenTable_daal = createCenTableDAAL();
+			// cenTable at daal side wraps the arena
+			NumericTable cenTable_daal = cen_arena.daal_table();
+			HomogenTableHarpTable<double[], DoubleArray, Table<DoubleArray> > cen_convert = 
+				new HomogenTableHarpTable<>(cenTable, cen_arena, this.numThreads);
 
 			// start the iteration
             for (int i = 0; i < numIterations; i++) {
 
 				//Convert Centroids data from Harp to DAAL
 				printTable(cenTable, 10, 10, i); 
-				convertCenTableHarpToDAAL(cenTable, cenTable_daal);
+				// no copy once the received centroids are adopted by the arena
+				cen_convert.HarpToDaalDouble();
 				// specify centroids data to daal kernel 
 				kmeansLocal.input.set(InputId.inputCentroids, cenTable_daal);
 				// first step of local computation by using DAAL kernels to get partial result
@@ -213,7 +214,7 @@ public class KMeansDaalCollectiveMapper
 			// Write out centroids
 			if (this.isMaster()) {
 				KMUtil.storeCentroids(this.conf, this.cenDir,
-						cenTable, this.cenVecSize, "output");
+						cenTable, this.vectorSize, "output");
 			}
 		
 			cenTable.release();
@@ -236,14 +237,14 @@ public class KMeansDaalCollectiveMapper
 
 		
 		/**
-		 * @brief create a harp table to hold centroids
-		 *
-		 * @param cenTable
+		 * @brief create the arena of centroids and bind 
+		 * the rows of each centroids partition, the same on all the mappers
 		 *
 		 * @return 
 		 */
-        private void createCenTable(Table<DoubleArray> cenTable)
+		private void createCenArena()
 		{
+			this.cen_arena = HarpDaalArena.allocateDouble(daal_Context, this.numCentroids, this.vectorSize);
 
 			int cenParSize =
 				this.numCentroids / this.numCenPars;
@@ -252,24 +253,34 @@ public class KMeansDaalCollectiveMapper
 
 			for (int i = 0; i < this.numCenPars; i++) {
 				if (cenRest > 0) {
-					int size = (cenParSize + 1) * this.cenVecSize;
-					DoubleArray array =
-						DoubleArray.create(size, false);
-					cenTable.addPartition(new Partition<>(i,
-								array));
+					cen_arena.bindRows(i, cenParSize + 1);
 					cenRest--;
 				} else if (cenParSize > 0) {
-					int size = cenParSize * cenVecSize;
-					DoubleArray array =
-						DoubleArray.create(size, false);
-					cenTable.addPartition(new Partition<>(i,
-								array));
+					cen_arena.bindRows(i, cenParSize);
 				} else {
 					break;
 				}
 			}
 		}
 
+		/**
+		 * @brief create a harp table to hold centroids
+		 * each partition is a view of its rows in the arena
+		 *
+		 * @param cenTable
+		 *
+		 * @return 
+		 */
+        private void createCenTable(Table<DoubleArray> cenTable)
+		{
+			for (int i = 0; i < this.numCenPars; i++) {
+				int rows = cen_arena.numRowsOf(i);
+				if (rows > 0)
+					cenTable.addPartition(new Partition<>(i,
+								cen_arena.doubleRows(i, rows)));
+			}
+		}
+
 		
 		/**
 		 * @brief load centroids data from hdfs to harp table
@@ -292,26 +303,26 @@ public class KMeansDaalCollectiveMapper
 						new InputStreamReader(in));
 			String[] curLine = null;
 			int curPos = 0;
-			for (Partition<DoubleArray> partition : cenTable
-					.getPartitions()) {
+			// read the partitions in the order of their rows
+			for (int id = 0; id < this.numCenPars; id++) {
+				Partition<DoubleArray> partition = cenTable.getPartition(id);
+				if (partition == null)
+					continue;
 				DoubleArray array = partition.get();
 				double[] cData = array.get();
 				int start = array.start();
 				int size = array.size();
 				for (int i = start; i < (start + size); i++) {
-					// Don't set the first element in each row
-					if (i % cenVecSize != 0) {
-						if (curLine == null
-								|| curPos == curLine.length) {
-							curLine = br.readLine().split(" ");
-							curPos = 0;
-								}
-						cData[i] =
-							Double.parseDouble(curLine[curPos]);
-						curPos++;
+					if (curLine == null
+							|| curPos == curLine.length) {
+						curLine = br.readLine().split(" ");
+						curPos = 0;
 					}
+					cData[i] =
+						Double.parseDouble(curLine[curPos]);
+					curPos++;
 				}
-					}
+			}
 			br.close();
 			long endTime = System.currentTimeMillis();
 			LOG.info("Load centroids (ms): "
@@ -395,88 +406,9 @@ public class KMeansDaalCollectiveMapper
 		}
 
 
-		/**
-		 * @brief create centroid table at DAAL side
-		 *
-		 * @return NumericTable at DAAL side 
-		 */
-		private NumericTable createCenTableDAAL()
-		{
-			//create daal table for cenTable first 
-			long nFeature_cen = this.vectorSize;
-			long totalLength_cen = this.numCentroids*nFeature_cen;
-			long tableSize_cen = totalLength_cen/nFeature_cen;
-			NumericTable cenTable_daal = new HomogenNumericTable(daal_Context, Double.class, nFeature_cen, tableSize_cen, NumericTable.AllocationFlag.DoAllocate);
-			this.buffer_array_cen = new double[(int)totalLength_cen];
-			return cenTable_daal;
-		}
-
-
-		/**
-		 * @brief convert model data (centroids) from harp to DAAL
-		 *
-		 * @param cenTable
-		 * @param cenTable_daal
-		 *
-		 * @return 
-		 */
-		private void convertCenTableHarpToDAAL(Table<DoubleArray> cenTable, NumericTable cenTable_daal)
-		{
-
-			long nFeature_cen = cenTable_daal.getNumberOfColumns(); 
-			long tableSize_cen = cenTable_daal.getNumberOfRows();
-			int cenTableNumPartition = cenTable.getNumPartitions();
-
-			this.array_startP_cen = new long[cenTable.getNumPartitions()];
-			this.sentinel_startP_cen = new long[cenTable.getNumPartitions()];
-			this.array_data_cen = new double[cenTable.getNumPartitions()][];
-
-			int ptr = 0;
-			long startP = 0;
-			long sentinel_startP = 0;
-			for (Partition<DoubleArray> partition : cenTable.getPartitions()) 
-			{
-				array_data_cen[ptr] = partition.get().get();
-				array_startP_cen[ptr] = startP;
-				sentinel_startP_cen[ptr] = sentinel_startP;
-				long increment = ((array_data_cen[ptr].length)/(this.cenVecSize));
-				sentinel_startP += increment;
-				startP += (increment*nFeature_cen);
-				ptr++;
-			}
-			
-			Arrays.fill(this.buffer_array_cen, 0);
-			Thread[] threads_cen = new Thread[this.numThreads];
-
-			//parallel copy partitions of cenTale into an entire primitive array
-			for (int q = 0; q<this.numThreads; q++) 
-			{
-				threads_cen[q] = new Thread(new TaskSentinelListToBufferDouble(q, this.numThreads, (int)nFeature_cen, cenTableNumPartition, array_startP_cen, array_data_cen, this.buffer_array_cen));
-				threads_cen[q].start();
-			}
-
-			for (int q = 0; q< this.numThreads; q++) {
-
-				try
-				{
-					threads_cen[q].join();
-
-				}catch(InterruptedException e)
-				{
-					System.out.println("Thread interrupted.");
-				}
-			}
-
-			//release the array into daal side cenTable
-			DoubleBuffer array_cen_buf = DoubleBuffer.wrap(this.buffer_array_cen);
-			cenTable_daal.releaseBlockOfRows(0, tableSize_cen, array_cen_buf);
-
-		}
-
-
 		/**
 		 * @brief Convert daal locally computed partial result to harp 
-		 * centroids table
+		 * centroids table and counts table
 		 *
 		 * @param cenTable
 		 * @param pres
@@ -486,29 +418,23 @@ public class KMeansDaalCollectiveMapper
 		private void convertCenTableDAALToHarp(Table<DoubleArray> cenTable, PartialResult pres)
 		{
 
-			int cenTableNumPartition = cenTable.getNumPartitions();
 			double[] partialSum = (double[]) ((HomogenNumericTable)pres.get(PartialResultId.partialSums)).getDoubleArray();
             double[] nObservations = (double[]) ((HomogenNumericTable)pres.get(PartialResultId.nObservations)).getDoubleArray();
 
-			//copy partialSum and nObservations back to cenTable
-			Thread[] threads_cen = new Thread[this.numThreads];
-			for (int q = 0; q<this.numThreads; q++) 
-			{
-				threads_cen[q] = new Thread(new TaskSentinelListUpdateDouble(q, this.numThreads, this.vectorSize, cenTableNumPartition, 
-							this.array_startP_cen, this.sentinel_startP_cen, this.array_data_cen, partialSum, nObservations));
-				threads_cen[q].start();
-			}
+			//the input centroids are no longer used, load partialSum into the arena
+			//then only the partitions not adopted by the arena are copied
+			System.arraycopy(partialSum, 0, (double[])cen_arena.arena(), 0, this.numCentroids*this.vectorSize);
+			cen_arena.copyOut(cenTable, this.numThreads);
 
-			for (int q = 0; q< this.numThreads; q++) {
-
-				try
-				{
-					threads_cen[q].join();
-
-				}catch(InterruptedException e)
-				{
-					System.out.println("Thread interrupted.");
-				}
+			//counts of the centroids in each partition
+			this.cntTable = new Table<>(1, new DoubleArrPlus());
+			for (Partition<DoubleArray> partition : cenTable.getPartitions()) 
+			{
+				int id = partition.id();
+				int rows = cen_arena.numRowsOf(id);
+				DoubleArray counts = DoubleArray.create(rows, false);
+				System.arraycopy(nObservations, cen_arena.rowOf(id), counts.get(), 0, rows);
+				this.cntTable.addPartition(new Partition<>(id, counts));
 			}
 		}
 
@@ -524,9 +450,12 @@ public class KMeansDaalCollectiveMapper
 		{
 			convertCenTableDAALToHarp(cenTable, pres);
 			regroup("main", "regroup", cenTable, new Partitioner(this.getNumWorkers()));
-			calculateAvgCenTable(cenTable);
+			regroup("main", "regroup-count", cntTable, new Partitioner(this.getNumWorkers()));
+			calculateAvgCenTable(cenTable, cntTable);
+			cntTable.release();
 			allgather("main", "allgather", cenTable);
 			this.barrier("main", "regroupallgather-sync");
+			cen_arena.adopt(cenTable, this.numThreads);
 		}
 
 		/**
@@ -541,8 +470,11 @@ public class KMeansDaalCollectiveMapper
 		{
 			convertCenTableDAALToHarp(cenTable, pres);
 			allreduce("main", "allreduce", cenTable);
+			allreduce("main", "allreduce-count", cntTable);
 			this.barrier("main", "allreduce-sync");
-			calculateAvgCenTable(cenTable);
+			calculateAvgCenTable(cenTable, cntTable);
+			cntTable.release();
+			cen_arena.adopt(cenTable, this.numThreads);
 		}
 
 		/**
@@ -558,12 +490,15 @@ public class KMeansDaalCollectiveMapper
 		{
 			convertCenTableDAALToHarp(cenTable, pres);
 			reduce("main", "reduce", cenTable, this.getMasterID());
+			reduce("main", "reduce-count", cntTable, this.getMasterID());
 
 			if (this.isMaster())
-				calculateAvgCenTable(cenTable);
+				calculateAvgCenTable(cenTable, cntTable);
 
+			cntTable.release();
 			broadcast("main", "bcast", cenTable, this.getMasterID(), false);
 			this.barrier("main", "braodcast-sync");
+			cen_arena.adopt(cenTable, this.numThreads);
 		}
 
 		/**
@@ -576,7 +511,7 @@ public class KMeansDaalCollectiveMapper
 		private void cleanTableContent(Table<DoubleArray> dataTable)
 		{
 			for(Partition<DoubleArray> ap : dataTable.getPartitions())
-				Arrays.fill(ap.get().get(), 0);
+				Arrays.fill(ap.get().get(), ap.get().start(), ap.get().start() + ap.get().size(), 0);
 		}
 
 		/**
@@ -595,27 +530,36 @@ public class KMeansDaalCollectiveMapper
 			if (pushpullGlobal == null)
 			{
 				pushpullGlobal = new Table<>(0, new DoubleArrPlus());
+				pushpullGlobalCnt = new Table<>(1, new DoubleArrPlus());
 				for(Partition<DoubleArray> ap : cenTable.getPartitions())
 				{
 					if (ap.id() % this.numMappers == this.getSelfID())
 					{
-						DoubleArray dummy = DoubleArray.create(ap.get().get().length, false);
+						DoubleArray dummy = DoubleArray.create(ap.get().size(), false);
 						pushpullGlobal.addPartition(new Partition<>(ap.id(), dummy));
+						DoubleArray dummy_cnt = DoubleArray.create(cen_arena.numRowsOf(ap.id()), false);
+						pushpullGlobalCnt.addPartition(new Partition<>(ap.id(), dummy_cnt));
 					}
 				}
 			}
 			else
+			{
 				cleanTableContent(pushpullGlobal);
+				cleanTableContent(pushpullGlobalCnt);
+			}
 
 			push("main", "push", cenTable, pushpullGlobal, new Partitioner(this.getNumWorkers()));
+			push("main", "push-count", cntTable, pushpullGlobalCnt, new Partitioner(this.getNumWorkers()));
+			cntTable.release();
 
-			calculateAvgCenTable(pushpullGlobal);
+			calculateAvgCenTable(pushpullGlobal, pushpullGlobalCnt);
 
 			//clean centable befor pull
 			cleanTableContent(cenTable);
 			
 			pull("main", "pull", cenTable, pushpullGlobal, false);
 			this.barrier("main", "pullsync");
+			cen_arena.adopt(cenTable, this.numThreads);
 
 		}
 
@@ -624,24 +568,24 @@ public class KMeansDaalCollectiveMapper
 		 * the mappers
 		 *
 		 * @param cenTable
+		 * @param countTable the counts of centroids in the same partitions
 		 *
 		 * @return 
 		 */
-		private void calculateAvgCenTable(Table<DoubleArray> cenTable)
+		private void calculateAvgCenTable(Table<DoubleArray> cenTable, Table<DoubleArray> countTable)
 		{
 
 			LinkedList<AvgCalcTask> avg_tasks = new LinkedList<>();
             for (int i = 0; i < this.numThreads; i++) {
-                avg_tasks.add(new AvgCalcTask(this.cenVecSize));
+                avg_tasks.add(new AvgCalcTask(this.vectorSize, countTable));
             }
 
-            DynamicScheduler<DoubleArray, Object, AvgCalcTask> avg_compute =
+            DynamicScheduler<Partition<DoubleArray>, Object, AvgCalcTask> avg_compute =
                 new DynamicScheduler<>(avg_tasks);
 
 			for (Partition<DoubleArray> partition : cenTable.getPartitions()) 
 			{
-				DoubleArray array = partition.get();
-				avg_compute.submit(array);
+				avg_compute.submit(partition);
 			}
 
             avg_compute.start();
@@ -677,11 +621,12 @@ public class KMeansDaalCollectiveMapper
 				if (ap != null)
 				{
 					double res[] = ap.get().get();
+					int res_start = ap.get().start();
 					System.out.print("ID: " + ap.id() + ": ");
 					System.out.flush();
-					col_print = (dim < res.length) ? dim : res.length;
+					col_print = (dim < ap.get().size()) ? dim : ap.get().size();
 					for (int j = 0; j < col_print; j++)
-						System.out.print(res[j] + "\t");
+						System.out.print(res[res_start + j] + "\t");
 					System.out.println();
 				}
 			}
@@ -698,11 +643,12 @@ public class KMeansDaalCollectiveMapper
 				for (Partition<DoubleArray> ap : dataTable.getPartitions())
 				{
 					double res[] = ap.get().get();
+					int res_start = ap.get().start();
 					System.out.print("ID: " + ap.id() + ": ");
 					System.out.flush();
-					col_print = (dim < res.length) ? dim : res.length;
+					col_print = (dim < ap.get().size()) ? dim : ap.get().size();
 					for (int j = 0; j < col_print; j++)
-						System.out.print(res[j] + "\t");
+						System.out.print(res[res_start + j] + "\t");
 					System.out.println();
 				}
 			// }
@@ -724,11 +670,12 @@ public class KMeansDaalCollectiveMapper
 			if (ap != null)
 			{
 				double res[] = ap.get().get();
+				int res_start = ap.get().start();
 				System.out.print("ID: " + ap.id() + ": ");
 				System.out.flush();
-				col_print = (dim < res.length) ? dim : res.length;
+				col_print = (dim < ap.get().size()) ? dim : ap.get().size();
 				for (int i = 0; i < col_print; i++)
-					System.out.print(res[i] + "\t");
+					System.out.print(res[res_start + i] + "\t");
 				System.out.println();
 			}
 		}
@@ -270,6 +270,11 @@ public class CCDMPCollectiveMapper extends
     // -----------------------------------------
     // For iteration
     for (int i = 1; i <= numIterations; i++) {
+      // Only count the rotations of training
+      wRotator.resetCommTime();
+      wRotator.resetExposedTime();
+      hRotator.resetCommTime();
+      hRotator.resetExposedTime();
       long iteStart = System.currentTimeMillis();
       // scheduler use row
       computeCCD(wRotator, hRotator, ccdCompute,
@@ -283,7 +288,12 @@ public class CCDMPCollectiveMapper extends
       long iteTime = iteEnd - iteStart;
       LOG.info("Iteration " + i + ": " + iteTime
         + ", compute time: " + computeTime + " "
-        + prepareResTime + ", misc: " + waitTime);
+        + prepareResTime + ", misc: " + waitTime
+        + ", rotation exposed/total: "
+        + (wRotator.resetExposedTime()
+          + hRotator.resetExposedTime())
+        + "/" + (wRotator.resetCommTime()
+          + hRotator.resetCommTime()));
       computeTime = 0L;
       prepareResTime = 0L;
       waitTime = 0L;
@@ -20,7 +20,6 @@ import edu.iu.harp.partition.Partition;
 import edu.iu.harp.partition.Table;
 import edu.iu.harp.resource.IntArray;
 import edu.iu.harp.resource.Simple;
-import edu.iu.harp.schstatic.Task;
 import it.unimi.dsi.fastutil.ints.Int2IntOpenHashMap;
 import it.unimi.dsi.fastutil.ints.IntArrays;
 import it.unimi.dsi.fastutil.objects.ObjectArrayList;
@@ -31,20 +30,23 @@ import org.apache.hadoop.mapred.CollectiveMapper;
 import java.util.List;
 import java.util.Random;
 
-public class RotateTask<P extends Simple>
-  extends Task<Integer, List<Partition<P>>[]> {
+/*******************************************************
+ * The splits and the rotation order of one model
+ * slice. The rotation itself is done by the
+ * RotationPipeline of the Rotator: call
+ * prepare() before the slice is rotated and
+ * split() after it arrives.
+ ******************************************************/
+public class RotateTask<P extends Simple> {
 
   protected static final Log LOG =
     LogFactory.getLog(RotateTask.class);
 
-  private final CollectiveMapper<?, ?, ?, ?> mapper;
   private final Table<P> table;
   private final int numColSplits;
   private final List<Partition<P>>[] splitMap;
   private boolean randomSplit;
   private final Random random;
-  private final String contextName;
-  private int operationID;
 
   private final int[] orders;
   private final int orderRowLen;
@@ -53,12 +55,10 @@ public class RotateTask<P extends Simple>
   private Int2IntOpenHashMap dataWorkerMap;
   private Int2IntOpenHashMap rotationMap;
 
-  private long commTime;
-
   public RotateTask(Table<P> table,
     int numColSplits, boolean randomSplit,
     CollectiveMapper<?, ?, ?, ?> mapper,
-    int[] orders, String contextName) {
+    int[] orders) {
     this.table = table;
     this.numColSplits = numColSplits;
     this.randomSplit = randomSplit;
@@ -73,9 +73,6 @@ public class RotateTask<P extends Simple>
     } else {
       splitTable();
     }
-    this.mapper = mapper;
-    this.contextName = contextName;
-    operationID = 0;
     numWorkers = mapper.getNumWorkers();
 
     if (orders != null) {
@@ -96,30 +93,38 @@ public class RotateTask<P extends Simple>
       dataWorkerMap = null;
       rotationMap = null;
     }
-    commTime = 0L;
   }
 
   public List<Partition<P>>[] getSplitMap() {
     return splitMap;
   }
 
-  @Override
-  public List<Partition<P>>[] run(Integer cmd)
-    throws Exception {
-    long t1 = System.currentTimeMillis();
+  /**
+   * Clear the splits and move to the next
+   * rotation in the order
+   * 
+   * @return the map from worker to worker of
+   *         the next rotation, null to rotate to
+   *         the next worker
+   */
+  Int2IntOpenHashMap prepare() {
     cleanSplitMap();
     updateRotationMap();
-    mapper.rotate(contextName, "rotate-"
-      + table.getTableID() + "-" + operationID,
-      table, rotationMap);
+    return rotationMap;
+  }
+
+  /**
+   * Split the partitions received by the
+   * rotation
+   * 
+   * @return the split map
+   */
+  List<Partition<P>>[] split() {
     if (randomSplit) {
       randomSplitTable();
     } else {
       splitTable();
     }
-    operationID++;
-    long t2 = System.currentTimeMillis();
-    commTime += (t2 - t1);
     return splitMap;
   }
 
@@ -208,10 +213,4 @@ public class RotateTask<P extends Simple>
       }
     }
   }
-
-  public long resetCommTime() {
-    long time = commTime;
-    commTime = 0L;
-    return time;
-  }
 }
@@ -16,23 +16,31 @@
 
 package edu.iu.dymoro;
 
+import edu.iu.harp.collective.RotationPipeline;
 import edu.iu.harp.partition.Partition;
 import edu.iu.harp.partition.Table;
 import edu.iu.harp.resource.Simple;
-import edu.iu.harp.schstatic.StaticScheduler;
 import org.apache.commons.logging.Log;
 import org.apache.commons.logging.LogFactory;
 import org.apache.hadoop.mapred.CollectiveMapper;
 
-import java.util.LinkedList;
 import java.util.List;
 
+/*******************************************************
+ * Rotate the model slices in the background
+ * through the RotationPipeline of the collective
+ * layer. rotate(taskID) sends a slice on after
+ * the computation, getSplitMap(taskID) waits for
+ * it only if it is still in flight.
+ ******************************************************/
 public class Rotator<P extends Simple> {
 
   protected static final Log LOG =
     LogFactory.getLog(Rotator.class);
 
-  private StaticScheduler<Integer, List<Partition<P>>[], RotateTask<P>> rotation;
+  private final RotationPipeline<P> pipeline;
+  private final RotateTask<P>[] rotateTasks;
+  private final boolean[] isRotating;
   private final int numTasks;
 
   public Rotator(Table<P>[] tableMap,
@@ -40,47 +48,85 @@ public class Rotator<P extends Simple> {
     CollectiveMapper<?, ?, ?, ?> mapper,
     int[] orders, String contextName) {
     numTasks = tableMap.length;
-    List<RotateTask<P>> rotateTasks =
-      new LinkedList<>();
+    rotateTasks = new RotateTask[numTasks];
+    isRotating = new boolean[numTasks];
     for (int i = 0; i < numTasks; i++) {
-      rotateTasks.add(new RotateTask<>(
+      rotateTasks[i] = new RotateTask<>(
         tableMap[i], numSplits, randomSplit,
-        mapper, orders, contextName));
+        mapper, orders);
     }
-    rotation = new StaticScheduler<>(rotateTasks);
+    pipeline = mapper
+      .createRotationPipeline(contextName, tableMap);
   }
 
   public List<Partition<P>>[]
     getSplitMap(int taskID) {
-    List<Partition<P>>[] splitMap = null;
-    if (rotation.hasOutput(taskID)) {
-      splitMap = rotation.waitForOutput(taskID);
+    if (isRotating[taskID]) {
+      // Blocked only if the slice is in flight
+      pipeline.getSlice(taskID);
+      isRotating[taskID] = false;
+      return rotateTasks[taskID].split();
     } else {
-      splitMap =
-        rotation.getTask(taskID).getSplitMap();
+      return rotateTasks[taskID].getSplitMap();
     }
-    return splitMap;
   }
 
   public void rotate(int taskID) {
-    rotation.submit(taskID, 1);
+    if (isRotating[taskID]) {
+      getSplitMap(taskID);
+    }
+    pipeline.rotate(taskID,
+      rotateTasks[taskID].prepare());
+    isRotating[taskID] = true;
   }
 
+  /**
+   * The rotations run on the collective layer,
+   * there is no thread to start
+   */
   public void start() {
-    rotation.start();
   }
 
+  /**
+   * Wait for the slices in flight, then the
+   * model tables can be accessed
+   */
   public void pause() {
-    rotation.pause();
+    for (int i = 0; i < numTasks; i++) {
+      if (isRotating[i]) {
+        getSplitMap(i);
+      }
+    }
   }
 
   public void stop() {
-    rotation.stop();
+    pause();
+  }
+
+  /**
+   * Get and reset the total rotation time of all
+   * the slices
+   * 
+   * @return the rotation time in milliseconds
+   */
+  public long resetCommTime() {
+    return pipeline.resetCommTime();
+  }
+
+  /**
+   * Get and reset the rotation time not hidden
+   * behind computation
+   * 
+   * @return the exposed rotation time in
+   *         milliseconds
+   */
+  public long resetExposedTime() {
+    return pipeline.resetExposedTime();
   }
 
   public void setRandomSplit(boolean b) {
     for (int i = 0; i < numTasks; i++) {
-      rotation.getTask(i).setRandomSplit(b);
+      rotateTasks[i].setRandomSplit(b);
     }
   }
 }
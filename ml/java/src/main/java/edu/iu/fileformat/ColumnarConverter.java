@@ -0,0 +1,209 @@
+/*
+ * Copyright 2013-2017 Indiana University
+ * 
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+package edu.iu.fileformat;
+
+import org.apache.commons.logging.Log;
+import org.apache.commons.logging.LogFactory;
+import org.apache.hadoop.conf.Configuration;
+import org.apache.hadoop.fs.FileStatus;
+import org.apache.hadoop.fs.FileSystem;
+import org.apache.hadoop.fs.Path;
+
+import java.io.BufferedInputStream;
+import java.io.BufferedOutputStream;
+import java.io.BufferedReader;
+import java.io.DataInputStream;
+import java.io.EOFException;
+import java.io.IOException;
+import java.io.InputStreamReader;
+
+/*******************************************************
+ * Convert the existing input files to the
+ * columnar format.
+ * 
+ * ratings: text lines of "rowID colID value", as
+ * read by sgd and ccd
+ * 
+ * docs: text lines of "docName wordID wordID
+ * ...", as read by lda
+ * 
+ * points: big endian doubles, as generated for
+ * kmeans; the dimension is required
+ * 
+ * Usage: ColumnarConverter ratings|docs|points
+ * input output [dim] [blockBytes]. If the input
+ * is a directory, each file in it is converted
+ * to a file with the same name in the output
+ * directory.
+ ******************************************************/
+public class ColumnarConverter {
+
+  private static final Log LOG =
+    LogFactory.getLog(ColumnarConverter.class);
+
+  public static void main(String[] args)
+    throws Exception {
+    if (args.length < 3) {
+      System.err.println("Usage: "
+        + "edu.iu.fileformat.ColumnarConverter "
+        + "<ratings|docs|points> <input> <output> "
+        + "[dim] [blockBytes]");
+      System.exit(-1);
+    }
+    int kind = getKind(args[0]);
+    Path input = new Path(args[1]);
+    Path output = new Path(args[2]);
+    int dim = args.length > 3
+      ? Integer.parseInt(args[3]) : 0;
+    int blockBytes = args.length > 4
+      ? Integer.parseInt(args[4])
+      : ColumnarWriter.DEFAULT_BLOCK_BYTES;
+    Configuration conf = new Configuration();
+    FileSystem inFs = input.getFileSystem(conf);
+    FileSystem outFs = output.getFileSystem(conf);
+    if (inFs.getFileStatus(input).isDirectory()) {
+      outFs.mkdirs(output);
+      for (FileStatus status : inFs
+        .listStatus(input)) {
+        if (status.isFile()) {
+          convert(kind, dim, blockBytes,
+            status.getPath(), new Path(output,
+              status.getPath().getName()),
+            conf);
+        }
+      }
+    } else {
+      convert(kind, dim, blockBytes, input,
+        output, conf);
+    }
+  }
+
+  private static int getKind(String kind) {
+    if (kind.equals("ratings")) {
+      return ColumnarFile.RATINGS;
+    } else if (kind.equals("docs")) {
+      return ColumnarFile.DOCS;
+    } else if (kind.equals("points")) {
+      return ColumnarFile.POINTS;
+    } else {
+      throw new IllegalArgumentException(
+        "Unknown record kind " + kind);
+    }
+  }
+
+  /**
+   * Convert one file
+   * 
+   * @param kind
+   *          the kind of records
+   * @param dim
+   *          the point dimension
+   * @param blockBytes
+   *          the block size in bytes
+   * @param input
+   *          the input file
+   * @param output
+   *          the output file
+   * @param conf
+   *          the configuration
+   * @throws IOException
+   */
+  public static void convert(int kind, int dim,
+    int blockBytes, Path input, Path output,
+    Configuration conf) throws IOException {
+    long start = System.currentTimeMillis();
+    FileSystem inFs = input.getFileSystem(conf);
+    FileSystem outFs = output.getFileSystem(conf);
+    ColumnarWriter writer = new ColumnarWriter(
+      new BufferedOutputStream(
+        outFs.create(output, true), 1048576),
+      kind, dim, blockBytes);
+    long numRecords = 0L;
+    try {
+      if (kind == ColumnarFile.POINTS) {
+        DataInputStream in = new DataInputStream(
+          new BufferedInputStream(
+            inFs.open(input), 1048576));
+        try {
+          double[] point = new double[dim];
+          while (readPoint(in, point)) {
+            writer.addPoint(point, 0);
+            numRecords++;
+          }
+        } finally {
+          in.close();
+        }
+      } else {
+        BufferedReader reader =
+          new BufferedReader(new InputStreamReader(
+            inFs.open(input)), 1048576);
+        try {
+          int[] wordIDs = new int[1024];
+          String line = null;
+          while ((line = reader.readLine()) != null) {
+            line = line.trim();
+            if (line.isEmpty()) {
+              continue;
+            }
+            String[] tokens =
+              line.split("\\p{Blank}+");
+            if (kind == ColumnarFile.RATINGS) {
+              writer.addRating(
+                Integer.parseInt(tokens[0]),
+                Integer.parseInt(tokens[1]),
+                Double.parseDouble(tokens[2]));
+            } else {
+              wordIDs = ColumnarFile.ensure(wordIDs,
+                tokens.length - 1);
+              for (int i = 1; i < tokens.length; i++) {
+                wordIDs[i - 1] =
+                  Integer.parseInt(tokens[i]);
+              }
+              writer.addDoc(tokens[0], wordIDs,
+                tokens.length - 1);
+            }
+            numRecords++;
+          }
+        } finally {
+          reader.close();
+        }
+      }
+    } finally {
+      writer.close();
+    }
+    LOG.info("Convert " + input + " to " + output
+      + ", records: " + numRecords + ", took: "
+      + (System.currentTimeMillis() - start));
+  }
+
+  /**
+   * Read a point, return false at the end of the
+   * stream
+   */
+  private static boolean readPoint(
+    DataInputStream in, double[] point)
+    throws IOException {
+    try {
+      point[0] = in.readDouble();
+    } catch (EOFException e) {
+      return false;
+    }
+    for (int i = 1; i < point.length; i++) {
+      point[i] = in.readDouble();
+    }
+    return true;
+  }
+}
@@ -0,0 +1,397 @@
+/*
+ * Copyright 2013-2017 Indiana University
+ * 
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+package edu.iu.fileformat;
+
+import org.apache.hadoop.conf.Configuration;
+import org.apache.hadoop.fs.FSDataInputStream;
+import org.apache.hadoop.fs.FileSystem;
+import org.apache.hadoop.fs.Path;
+
+import java.io.File;
+import java.io.IOException;
+import java.nio.ByteBuffer;
+import java.nio.ByteOrder;
+import java.nio.DoubleBuffer;
+import java.nio.channels.FileChannel;
+import java.nio.charset.StandardCharsets;
+import java.nio.file.StandardOpenOption;
+import java.util.Arrays;
+import java.util.LinkedList;
+import java.util.List;
+
+/*******************************************************
+ * The columnar binary format of training data.
+ * 
+ * A file starts with a header (magic, kind,
+ * point dimension), followed by blocks of
+ * records and a block index. Each block stores
+ * its records column by column in little endian:
+ * 
+ * RATINGS: int[n] rowIDs, int[n] colIDs,
+ * double[n] values
+ * 
+ * DOCS: int[n] numWords, int[numValues] wordIDs,
+ * int[n] nameLengths, byte[] UTF-8 doc names
+ * 
+ * POINTS: double[n * dim] values
+ * 
+ * The index holds (offset, length, numRecords,
+ * numValues) per block. The trailer holds the
+ * index offset, the number of blocks and the
+ * magic again. Blocks are 8-byte aligned so
+ * they can be viewed as int/double buffers.
+ ******************************************************/
+public class ColumnarFile {
+
+  static final byte[] MAGIC = "HARPCOL1"
+    .getBytes(StandardCharsets.US_ASCII);
+  static final int HEADER_SIZE = 16;
+  static final int INDEX_ENTRY_SIZE = 24;
+  static final int TRAILER_SIZE = 24;
+
+  /** A whole text file, not columnar */
+  public static final int TEXT = 0;
+  /** Rating triples: row ID, column ID, value */
+  public static final int RATINGS = 1;
+  /** Documents: a name and a list of word IDs */
+  public static final int DOCS = 2;
+  /** Dense points of a fixed dimension */
+  public static final int POINTS = 3;
+
+  /**
+   * Check if a file is in the columnar format
+   * 
+   * @param file
+   *          the file path
+   * @param conf
+   *          the configuration
+   * @return true if columnar, false otherwise
+   * @throws IOException
+   */
+  public static boolean isColumnar(String file,
+    Configuration conf) throws IOException {
+    Path path = new Path(file);
+    FileSystem fs = path.getFileSystem(conf);
+    if (fs.getFileStatus(path)
+      .getLen() < HEADER_SIZE + TRAILER_SIZE) {
+      return false;
+    }
+    byte[] magic = new byte[MAGIC.length];
+    FSDataInputStream in = fs.open(path);
+    try {
+      in.readFully(0L, magic);
+    } finally {
+      in.close();
+    }
+    return Arrays.equals(magic, MAGIC);
+  }
+
+  /**
+   * Split the files into loading blocks. Each
+   * text file becomes one block, each columnar
+   * file contributes all its blocks.
+   * 
+   * @param files
+   *          the file paths
+   * @param conf
+   *          the configuration
+   * @return the list of blocks
+   * @throws IOException
+   */
+  public static List<FileBlock> getBlocks(
+    List<String> files, Configuration conf)
+    throws IOException {
+    List<FileBlock> blocks = new LinkedList<>();
+    for (String file : files) {
+      if (isColumnar(file, conf)) {
+        blocks.addAll(getBlocks(file, conf));
+      } else {
+        blocks.add(new FileBlock(file));
+      }
+    }
+    return blocks;
+  }
+
+  /**
+   * Read the block index of a columnar file
+   * 
+   * @param file
+   *          the file path
+   * @param conf
+   *          the configuration
+   * @return the list of blocks
+   * @throws IOException
+   */
+  public static List<FileBlock> getBlocks(
+    String file, Configuration conf)
+    throws IOException {
+    Path path = new Path(file);
+    FileSystem fs = path.getFileSystem(conf);
+    long fileLen = fs.getFileStatus(path).getLen();
+    FSDataInputStream in = fs.open(path);
+    try {
+      byte[] headerBytes = new byte[HEADER_SIZE];
+      in.readFully(0L, headerBytes);
+      ByteBuffer header = ByteBuffer
+        .wrap(headerBytes)
+        .order(ByteOrder.LITTLE_ENDIAN);
+      header.position(MAGIC.length);
+      int kind = header.getInt();
+      int dim = header.getInt();
+      byte[] trailerBytes = new byte[TRAILER_SIZE];
+      in.readFully(fileLen - TRAILER_SIZE,
+        trailerBytes);
+      ByteBuffer trailer = ByteBuffer
+        .wrap(trailerBytes)
+        .order(ByteOrder.LITTLE_ENDIAN);
+      long indexOffset = trailer.getLong();
+      int numBlocks = trailer.getInt();
+      trailer.getInt();
+      byte[] magic = new byte[MAGIC.length];
+      trailer.get(magic);
+      if (!Arrays.equals(magic, MAGIC)) {
+        throw new IOException(
+          "Incomplete columnar file " + file);
+      }
+      byte[] indexBytes =
+        new byte[numBlocks * INDEX_ENTRY_SIZE];
+      in.readFully(indexOffset, indexBytes);
+      ByteBuffer index = ByteBuffer
+        .wrap(indexBytes)
+        .order(ByteOrder.LITTLE_ENDIAN);
+      List<FileBlock> blocks = new LinkedList<>();
+      for (int i = 0; i < numBlocks; i++) {
+        long offset = index.getLong();
+        long length = index.getLong();
+        int numRecords = index.getInt();
+        int numValues = index.getInt();
+        blocks.add(new FileBlock(file, kind, dim,
+          offset, length, numRecords, numValues));
+      }
+      return blocks;
+    } finally {
+      in.close();
+    }
+  }
+
+  /**
+   * Get the bytes of a block. Blocks of local
+   * files are memory-mapped, blocks of other
+   * file systems are read with one positional
+   * read.
+   * 
+   * @param block
+   *          the block
+   * @param conf
+   *          the configuration
+   * @return the block in a little endian buffer
+   * @throws IOException
+   */
+  public static ByteBuffer readBlock(
+    FileBlock block, Configuration conf)
+    throws IOException {
+    Path path = new Path(block.getFile());
+    FileSystem fs = path.getFileSystem(conf);
+    Path qualified = fs.makeQualified(path);
+    ByteBuffer buffer = null;
+    if ("file"
+      .equals(qualified.toUri().getScheme())) {
+      File file =
+        new File(qualified.toUri().getPath());
+      // The mapping stays valid after the
+      // channel is closed
+      try (FileChannel channel = FileChannel.open(
+        file.toPath(), StandardOpenOption.READ)) {
+        buffer = channel.map(
+          FileChannel.MapMode.READ_ONLY,
+          block.getOffset(), block.getLength());
+      }
+    } else {
+      byte[] bytes = new byte[(int) block.getLength()];
+      FSDataInputStream in = fs.open(path);
+      try {
+        in.readFully(block.getOffset(), bytes);
+      } finally {
+        in.close();
+      }
+      buffer = ByteBuffer.wrap(bytes);
+    }
+    return buffer.order(ByteOrder.LITTLE_ENDIAN);
+  }
+
+  /**
+   * Read the columns of a RATINGS block
+   * 
+   * @param buffer
+   *          the block buffer
+   * @param numRecords
+   *          the number of records
+   * @param rowIDs
+   *          the array to fill with row IDs
+   * @param colIDs
+   *          the array to fill with column IDs
+   * @param values
+   *          the array to fill with values
+   */
+  public static void readRatings(ByteBuffer buffer,
+    int numRecords, int[] rowIDs, int[] colIDs,
+    double[] values) {
+    buffer.position(0);
+    buffer.asIntBuffer().get(rowIDs, 0,
+      numRecords);
+    buffer.position(numRecords * 4);
+    buffer.asIntBuffer().get(colIDs, 0,
+      numRecords);
+    buffer.position(numRecords * 8);
+    buffer.asDoubleBuffer().get(values, 0,
+      numRecords);
+  }
+
+  /**
+   * Read the word columns of a DOCS block. The
+   * doc names follow and can be read with
+   * readDocName from the returned position.
+   * 
+   * @param buffer
+   *          the block buffer
+   * @param numRecords
+   *          the number of docs
+   * @param numValues
+   *          the total number of words
+   * @param numWords
+   *          the array to fill with the number of
+   *          words per doc
+   * @param wordIDs
+   *          the array to fill with word IDs
+   * @param nameLengths
+   *          the array to fill with the lengths
+   *          of doc names
+   * @return the position of the first doc name
+   */
+  public static int readDocs(ByteBuffer buffer,
+    int numRecords, int numValues, int[] numWords,
+    int[] wordIDs, int[] nameLengths) {
+    buffer.position(0);
+    buffer.asIntBuffer().get(numWords, 0,
+      numRecords);
+    int pos = numRecords * 4;
+    buffer.position(pos);
+    buffer.asIntBuffer().get(wordIDs, 0,
+      numValues);
+    pos += numValues * 4;
+    buffer.position(pos);
+    buffer.asIntBuffer().get(nameLengths, 0,
+      numRecords);
+    return pos + numRecords * 4;
+  }
+
+  /**
+   * Read a doc name of a DOCS block
+   * 
+   * @param buffer
+   *          the block buffer
+   * @param pos
+   *          the position of the name
+   * @param length
+   *          the length of the name in bytes
+   * @param bytes
+   *          a scratch array of at least length
+   *          bytes
+   * @return the doc name
+   */
+  public static String readDocName(
+    ByteBuffer buffer, int pos, int length,
+    byte[] bytes) {
+    buffer.position(pos);
+    buffer.get(bytes, 0, length);
+    return new String(bytes, 0, length,
+      StandardCharsets.UTF_8);
+  }
+
+  /**
+   * Read the points of a POINTS block into an
+   * array. Each point is stored after a gap of
+   * pointOffset slots, e.g. KMeans keeps the
+   * minimum distance in the first slot.
+   * 
+   * @param buffer
+   *          the block buffer
+   * @param numPoints
+   *          the number of points
+   * @param dim
+   *          the point dimension
+   * @param points
+   *          the array to fill
+   * @param start
+   *          the start position in the array
+   * @param pointOffset
+   *          the number of slots before each
+   *          point
+   * @return the position after the last point
+   */
+  public static int readPoints(ByteBuffer buffer,
+    int numPoints, int dim, double[] points,
+    int start, int pointOffset) {
+    buffer.position(0);
+    if (pointOffset == 0) {
+      buffer.asDoubleBuffer().get(points, start,
+        numPoints * dim);
+      return start + numPoints * dim;
+    }
+    DoubleBuffer values =
+      buffer.asDoubleBuffer();
+    int pos = start;
+    for (int i = 0; i < numPoints; i++) {
+      pos += pointOffset;
+      values.get(points, pos, dim);
+      pos += dim;
+    }
+    return pos;
+  }
+
+  /**
+   * Grow an int array if it is too small
+   */
+  public static int[] ensure(int[] array,
+    int size) {
+    if (array == null || array.length < size) {
+      return new int[size];
+    }
+    return array;
+  }
+
+  /**
+   * Grow a double array if it is too small
+   */
+  public static double[] ensure(double[] array,
+    int size) {
+    if (array == null || array.length < size) {
+      return new double[size];
+    }
+    return array;
+  }
+
+  /**
+   * Grow a byte array if it is too small
+   */
+  public static byte[] ensure(byte[] array,
+    int size) {
+    if (array == null || array.length < size) {
+      return new byte[size];
+    }
+    return array;
+  }
+}
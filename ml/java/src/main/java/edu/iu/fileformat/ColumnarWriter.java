@@ -0,0 +1,304 @@
+/*
+ * Copyright 2013-2017 Indiana University
+ * 
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+package edu.iu.fileformat;
+
+import it.unimi.dsi.fastutil.longs.LongArrayList;
+
+import java.io.ByteArrayOutputStream;
+import java.io.Closeable;
+import java.io.IOException;
+import java.io.OutputStream;
+import java.nio.ByteBuffer;
+import java.nio.ByteOrder;
+import java.nio.charset.StandardCharsets;
+
+/*******************************************************
+ * Write records to a columnar file block by
+ * block. A block is written when its size
+ * reaches the given number of bytes, the index
+ * and the trailer are written on close. See
+ * ColumnarFile for the layout.
+ ******************************************************/
+public class ColumnarWriter implements Closeable {
+
+  /** The default block size in bytes */
+  public static final int DEFAULT_BLOCK_BYTES =
+    16 * 1024 * 1024;
+
+  private final OutputStream out;
+  private final int kind;
+  private final int dim;
+  private final int blockBytes;
+  private long position;
+  // offset, length, numRecords and numValues
+  // of each block written
+  private final LongArrayList index;
+  private int numRecords;
+  private int numValues;
+  private int[] ints1;
+  private int[] ints2;
+  private int[] ints3;
+  private double[] doubles;
+  private final ByteArrayOutputStream names;
+
+  /**
+   * Create a writer and write the header
+   * 
+   * @param out
+   *          the output stream
+   * @param kind
+   *          RATINGS, DOCS or POINTS
+   * @param dim
+   *          the point dimension for POINTS, 0
+   *          otherwise
+   * @param blockBytes
+   *          the approximate block size in bytes
+   * @throws IOException
+   */
+  public ColumnarWriter(OutputStream out,
+    int kind, int dim, int blockBytes)
+    throws IOException {
+    if (kind != ColumnarFile.RATINGS
+      && kind != ColumnarFile.DOCS
+      && kind != ColumnarFile.POINTS) {
+      throw new IllegalArgumentException(
+        "Unknown record kind " + kind);
+    }
+    if (kind == ColumnarFile.POINTS && dim <= 0) {
+      throw new IllegalArgumentException(
+        "Invalid point dimension " + dim);
+    }
+    this.out = out;
+    this.kind = kind;
+    this.dim = dim;
+    this.blockBytes = blockBytes;
+    position = 0L;
+    index = new LongArrayList();
+    numRecords = 0;
+    numValues = 0;
+    ints1 = new int[1024];
+    ints2 = new int[1024];
+    ints3 = new int[1024];
+    doubles = new double[1024];
+    names = new ByteArrayOutputStream();
+    ByteBuffer header = ByteBuffer
+      .allocate(ColumnarFile.HEADER_SIZE)
+      .order(ByteOrder.LITTLE_ENDIAN);
+    header.put(ColumnarFile.MAGIC);
+    header.putInt(kind);
+    header.putInt(dim);
+    write(header.array());
+  }
+
+  /**
+   * Add a rating to a RATINGS file
+   */
+  public void addRating(int rowID, int colID,
+    double value) throws IOException {
+    ints1 = grow(ints1, numRecords + 1);
+    ints2 = grow(ints2, numRecords + 1);
+    doubles = grow(doubles, numRecords + 1);
+    ints1[numRecords] = rowID;
+    ints2[numRecords] = colID;
+    doubles[numRecords] = value;
+    numRecords++;
+    numValues++;
+    if (getBlockSize() >= blockBytes) {
+      writeBlock();
+    }
+  }
+
+  /**
+   * Add a doc to a DOCS file
+   * 
+   * @param name
+   *          the doc name
+   * @param wordIDs
+   *          the word IDs
+   * @param numWords
+   *          the number of word IDs
+   */
+  public void addDoc(String name, int[] wordIDs,
+    int numWords) throws IOException {
+    byte[] nameBytes =
+      name.getBytes(StandardCharsets.UTF_8);
+    ints1 = grow(ints1, numRecords + 1);
+    ints2 = grow(ints2, numValues + numWords);
+    ints3 = grow(ints3, numRecords + 1);
+    ints1[numRecords] = numWords;
+    System.arraycopy(wordIDs, 0, ints2, numValues,
+      numWords);
+    ints3[numRecords] = nameBytes.length;
+    names.write(nameBytes);
+    numRecords++;
+    numValues += numWords;
+    if (getBlockSize() >= blockBytes) {
+      writeBlock();
+    }
+  }
+
+  /**
+   * Add a point to a POINTS file
+   * 
+   * @param point
+   *          the array holding the point
+   * @param start
+   *          the start of the point in the array
+   */
+  public void addPoint(double[] point, int start)
+    throws IOException {
+    doubles = grow(doubles, numValues + dim);
+    System.arraycopy(point, start, doubles,
+      numValues, dim);
+    numRecords++;
+    numValues += dim;
+    if (getBlockSize() >= blockBytes) {
+      writeBlock();
+    }
+  }
+
+  /**
+   * Get the size of the current block without
+   * padding
+   * 
+   * @return the size in bytes
+   */
+  private long getBlockSize() {
+    if (kind == ColumnarFile.RATINGS) {
+      return numRecords * 16L;
+    } else if (kind == ColumnarFile.DOCS) {
+      return numRecords * 8L + numValues * 4L
+        + names.size();
+    } else {
+      return numValues * 8L;
+    }
+  }
+
+  /**
+   * Write the current block and add it to the
+   * index
+   * 
+   * @throws IOException
+   */
+  private void writeBlock() throws IOException {
+    if (numRecords == 0) {
+      return;
+    }
+    long size = getBlockSize();
+    int length = (int) ((size + 7L) & ~7L);
+    ByteBuffer block = ByteBuffer.allocate(length)
+      .order(ByteOrder.LITTLE_ENDIAN);
+    if (kind == ColumnarFile.RATINGS) {
+      block.asIntBuffer().put(ints1, 0,
+        numRecords);
+      block.position(numRecords * 4);
+      block.asIntBuffer().put(ints2, 0,
+        numRecords);
+      block.position(numRecords * 8);
+      block.asDoubleBuffer().put(doubles, 0,
+        numRecords);
+    } else if (kind == ColumnarFile.DOCS) {
+      block.asIntBuffer().put(ints1, 0,
+        numRecords);
+      int pos = numRecords * 4;
+      block.position(pos);
+      block.asIntBuffer().put(ints2, 0,
+        numValues);
+      pos += numValues * 4;
+      block.position(pos);
+      block.asIntBuffer().put(ints3, 0,
+        numRecords);
+      pos += numRecords * 4;
+      block.position(pos);
+      block.put(names.toByteArray());
+      names.reset();
+    } else {
+      block.asDoubleBuffer().put(doubles, 0,
+        numValues);
+    }
+    index.add(position);
+    index.add(length);
+    index.add(numRecords);
+    index.add(numValues);
+    write(block.array());
+    numRecords = 0;
+    numValues = 0;
+  }
+
+  /**
+   * Write the last block, the index and the
+   * trailer, then close the output stream
+   */
+  @Override
+  public void close() throws IOException {
+    try {
+      writeBlock();
+      int numBlocks = index.size() / 4;
+      long indexOffset = position;
+      ByteBuffer indexBuf = ByteBuffer
+        .allocate(
+          numBlocks * ColumnarFile.INDEX_ENTRY_SIZE)
+        .order(ByteOrder.LITTLE_ENDIAN);
+      for (int i = 0; i < index.size(); i += 4) {
+        indexBuf.putLong(index.getLong(i));
+        indexBuf.putLong(index.getLong(i + 1));
+        indexBuf.putInt((int) index.getLong(i + 2));
+        indexBuf.putInt((int) index.getLong(i + 3));
+      }
+      write(indexBuf.array());
+      ByteBuffer trailer = ByteBuffer
+        .allocate(ColumnarFile.TRAILER_SIZE)
+        .order(ByteOrder.LITTLE_ENDIAN);
+      trailer.putLong(indexOffset);
+      trailer.putInt(numBlocks);
+      trailer.putInt(0);
+      trailer.put(ColumnarFile.MAGIC);
+      write(trailer.array());
+    } finally {
+      out.close();
+    }
+  }
+
+  private void write(byte[] bytes)
+    throws IOException {
+    out.write(bytes);
+    position += bytes.length;
+  }
+
+  private static int[] grow(int[] array,
+    int size) {
+    if (array.length >= size) {
+      return array;
+    }
+    int[] newArray = new int[Math.max(size,
+      array.length << 1)];
+    System.arraycopy(array, 0, newArray, 0,
+      array.length);
+    return newArray;
+  }
+
+  private static double[] grow(double[] array,
+    int size) {
+    if (array.length >= size) {
+      return array;
+    }
+    double[] newArray = new double[Math.max(size,
+      array.length << 1)];
+    System.arraycopy(array, 0, newArray, 0,
+      array.length);
+    return newArray;
+  }
+}
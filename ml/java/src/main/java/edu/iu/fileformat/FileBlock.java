@@ -0,0 +1,121 @@
+/*
+ * Copyright 2013-2017 Indiana University
+ * 
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+package edu.iu.fileformat;
+
+/*******************************************************
+ * A unit of loading work: either a whole text
+ * file, or one block of a columnar file. Large
+ * columnar files are split into blocks so that
+ * one file can be loaded by several threads.
+ ******************************************************/
+public class FileBlock {
+
+  private final String file;
+  private final int kind;
+  private final int dim;
+  private final long offset;
+  private final long length;
+  private final int numRecords;
+  private final int numValues;
+
+  /**
+   * Create a block covering a whole text file
+   * 
+   * @param file
+   *          the file path
+   */
+  public FileBlock(String file) {
+    this(file, ColumnarFile.TEXT, 0, 0L, -1L, -1,
+      -1);
+  }
+
+  /**
+   * Create a block of a columnar file
+   * 
+   * @param file
+   *          the file path
+   * @param kind
+   *          the kind of records
+   * @param dim
+   *          the point dimension, 0 if not points
+   * @param offset
+   *          the start of the block in the file
+   * @param length
+   *          the length of the block in bytes
+   * @param numRecords
+   *          the number of records in the block
+   * @param numValues
+   *          the number of values in the block
+   */
+  public FileBlock(String file, int kind, int dim,
+    long offset, long length, int numRecords,
+    int numValues) {
+    this.file = file;
+    this.kind = kind;
+    this.dim = dim;
+    this.offset = offset;
+    this.length = length;
+    this.numRecords = numRecords;
+    this.numValues = numValues;
+  }
+
+  public String getFile() {
+    return file;
+  }
+
+  /**
+   * Check if the block is in the columnar format
+   * 
+   * @return true if columnar, false if it is a
+   *         whole text file
+   */
+  public boolean isColumnar() {
+    return kind != ColumnarFile.TEXT;
+  }
+
+  public int getKind() {
+    return kind;
+  }
+
+  public int getDim() {
+    return dim;
+  }
+
+  public long getOffset() {
+    return offset;
+  }
+
+  public long getLength() {
+    return length;
+  }
+
+  public int getNumRecords() {
+    return numRecords;
+  }
+
+  public int getNumValues() {
+    return numValues;
+  }
+
+  @Override
+  public String toString() {
+    if (isColumnar()) {
+      return file + "@" + offset + "+" + length;
+    } else {
+      return file;
+    }
+  }
+}
@@ -23,40 +23,42 @@ import edu.iu.harp.schdynamic.Task;
 import org.apache.commons.logging.Log;
 import org.apache.commons.logging.LogFactory;
 
+import java.util.Arrays;
+
 public class CenCalcTask
   implements Task<double[], Object> {
 
   protected static final Log LOG =
     LogFactory.getLog(CenCalcTask.class);
 
-  private double[][] centroids;
+  private final DistanceKernel kernel;
   private double[][] local;
   private final int cenVecSize;
+  private int[] nearest;
+  private double[] minDistances;
+
+  private final double[] scratch;
 
+  /**
+   * The kernel is shared by all the tasks and
+   * packed from cenTable by the caller
+   */
   public CenCalcTask(Table<DoubleArray> cenTable,
-    int cenVecSize) {
-    centroids =
+    int cenVecSize, DistanceKernel kernel) {
+    local =
       new double[cenTable.getNumPartitions()][];
-    local = new double[centroids.length][];
     for (Partition<DoubleArray> partition : cenTable
       .getPartitions()) {
       int partitionID = partition.id();
       DoubleArray array = partition.get();
-      centroids[partitionID] = array.get();
       local[partitionID] =
         new double[array.size()];
     }
     this.cenVecSize = cenVecSize;
-  }
-
-  public void
-    update(Table<DoubleArray> cenTable) {
-    for (Partition<DoubleArray> partition : cenTable
-      .getPartitions()) {
-      int partitionID = partition.id();
-      DoubleArray array = partition.get();
-      centroids[partitionID] = array.get();
-    }
+    this.kernel = kernel;
+    scratch = kernel.newScratch();
+    nearest = new int[0];
+    minDistances = new double[0];
   }
 
   public double[][] getLocal() {
@@ -66,34 +68,29 @@ public class CenCalcTask
   @Override
   public Object run(double[] points)
     throws Exception {
-    for (int i = 0; i < points.length;) {
-      i++;
-      double minDistance = Double.MAX_VALUE;
-      int minCenParID = 0;
-      int minOffset = 0;
-      for (int j = 0; j < centroids.length; j++) {
-        for (int k = 0; k < local[j].length;) {
-          int pStart = i;
-          k++;
-          double distance = 0.0;
-          for (int l = 1; l < cenVecSize; l++) {
-            double diff = (points[pStart++]
-              - centroids[j][k++]);
-            distance += diff * diff;
-          }
-          if (distance < minDistance) {
-            minDistance = distance;
-            minCenParID = j;
-            minOffset = k - cenVecSize;
-          }
-        }
+    int numPoints = points.length / cenVecSize;
+    if (nearest.length < numPoints) {
+      nearest = new int[numPoints];
+      minDistances = new double[numPoints];
+    }
+    Arrays.fill(minDistances, 0, numPoints,
+      Double.MAX_VALUE);
+    kernel.findNearest(points, numPoints, nearest,
+      minDistances, scratch);
+    for (int p = 0; p < numPoints; p++) {
+      int c = nearest[p];
+      if (c < 0) {
+        continue;
       }
+      double[] localCen =
+        local[kernel.getPartitionID(c)];
+      int offset = kernel.getOffset(c);
       // Count + 1
-      local[minCenParID][minOffset++]++;
+      localCen[offset++]++;
       // Add the point
+      int i = p * cenVecSize + 1;
       for (int j = 1; j < cenVecSize; j++) {
-        local[minCenParID][minOffset++] +=
-          points[i++];
+        localCen[offset++] += points[i++];
       }
     }
     return null;
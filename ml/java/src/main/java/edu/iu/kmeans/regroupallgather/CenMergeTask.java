@@ -20,7 +20,7 @@ import edu.iu.harp.partition.Partition;
 import edu.iu.harp.resource.DoubleArray;
 import edu.iu.harp.schdynamic.Task;
 
-import java.util.Arrays;
+import java.util.ArrayList;
 import java.util.List;
 
 public class CenMergeTask implements
@@ -39,17 +39,15 @@ public class CenMergeTask implements
     int partitionID = cenPartition.id();
     double[] centroids = cenPartition.get().get();
     int cenSize = cenPartition.get().size();
-    Arrays.fill(centroids, 0.0);
     // It is safe to iterate concurrently
     // because each task has its own iterator
+    List<double[]> locals =
+      new ArrayList<>(cenCalcTasks.size());
     for (CenCalcTask task : cenCalcTasks) {
-      double[] localCentroids =
-        task.getLocal()[partitionID];
-      for (int i = 0; i < cenSize; i++) {
-        centroids[i] += localCentroids[i];
-        localCentroids[i] = 0.0;
-      }
+      locals.add(task.getLocal()[partitionID]);
     }
+    DistanceKernel.sumAndReset(centroids, locals,
+      cenSize);
     return null;
   }
 }
@@ -0,0 +1,339 @@
+/*
+ * Copyright 2013-2017 Indiana University
+ * 
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+package edu.iu.kmeans.regroupallgather;
+
+import edu.iu.harp.partition.Partition;
+import edu.iu.harp.resource.DoubleArray;
+
+import java.util.Collection;
+
+/*******************************************************
+ * A blocked kernel finding the nearest centroid
+ * of each point. Centroids are packed into one
+ * contiguous row-major array with their squared
+ * norms, and the squared distance is computed as
+ * ||x||^2 + ||c||^2 - 2 x.c. Points and
+ * centroids are tiled so that a centroid block
+ * stays in L2 cache while a point block is
+ * compared with it, and the dot products are
+ * computed for one point against four centroids
+ * at a time, which gives four independent
+ * accumulation chains and reuses each point
+ * element from a register.
+ * 
+ * Points are laid out as in KMeans point arrays:
+ * each point takes cenVecSize slots and the
+ * first slot is not part of the vector.
+ * Centroid partitions hold [count, c1..cd] rows.
+ * 
+ * The packed centroids are shared: one thread
+ * packs them while no task runs, then all the
+ * tasks read them concurrently, each with its
+ * own scratch from newScratch().
+ ******************************************************/
+public class DistanceKernel {
+
+  /** The bytes of centroids per tile */
+  static final int CEN_BLOCK_BYTES = 256 * 1024;
+  /** The bytes of points per tile */
+  static final int POINT_BLOCK_BYTES = 16 * 1024;
+
+  private final int cenVecSize;
+  private final int dim;
+  private final int cenBlockSize;
+  private final int pointBlockSize;
+  private int numCentroids;
+  // Packed centroid vectors, squared norms, and
+  // the location of each centroid
+  private double[] cenVecs;
+  private double[] cenNorms;
+  private int[] cenParIDs;
+  private int[] cenOffsets;
+
+  public DistanceKernel(int cenVecSize) {
+    this.cenVecSize = cenVecSize;
+    this.dim = cenVecSize - 1;
+    cenBlockSize = Math.max(4,
+      (CEN_BLOCK_BYTES / (8 * dim)) & ~3);
+    pointBlockSize =
+      Math.max(1, POINT_BLOCK_BYTES / (8 * dim));
+    numCentroids = 0;
+    cenVecs = new double[0];
+    cenNorms = new double[0];
+    cenParIDs = new int[0];
+    cenOffsets = new int[0];
+  }
+
+  /**
+   * Create the per-thread scratch used by
+   * findNearest
+   * 
+   * @return the scratch for a point block
+   */
+  public double[] newScratch() {
+    return new double[pointBlockSize];
+  }
+
+  /**
+   * Pack the centroids of the partitions, in the
+   * iteration order of the collection
+   * 
+   * @param partitions
+   *          the centroid partitions
+   */
+  public void pack(
+    Collection<Partition<DoubleArray>> partitions) {
+    int total = 0;
+    for (Partition<DoubleArray> partition : partitions) {
+      total += partition.get().size() / cenVecSize;
+    }
+    if (cenNorms.length < total) {
+      cenVecs = new double[total * dim];
+      cenNorms = new double[total];
+      cenParIDs = new int[total];
+      cenOffsets = new int[total];
+    }
+    int c = 0;
+    for (Partition<DoubleArray> partition : partitions) {
+      int partitionID = partition.id();
+      double[] array = partition.get().get();
+      int size = partition.get().size();
+      for (int offset = 0; offset
+        + cenVecSize <= size; offset +=
+          cenVecSize) {
+        int pos = c * dim;
+        double norm = 0.0;
+        for (int l = 1; l < cenVecSize; l++) {
+          double v = array[offset + l];
+          cenVecs[pos++] = v;
+          norm += v * v;
+        }
+        cenNorms[c] = norm;
+        cenParIDs[c] = partitionID;
+        cenOffsets[c] = offset;
+        c++;
+      }
+    }
+    numCentroids = c;
+  }
+
+  /**
+   * Get the number of packed centroids
+   * 
+   * @return the number of centroids
+   */
+  public int getNumCentroids() {
+    return numCentroids;
+  }
+
+  /**
+   * Get the partition ID of a packed centroid
+   * 
+   * @param c
+   *          the index of the packed centroid
+   * @return the partition ID
+   */
+  public int getPartitionID(int c) {
+    return cenParIDs[c];
+  }
+
+  /**
+   * Get the offset of a packed centroid in its
+   * partition array
+   * 
+   * @param c
+   *          the index of the packed centroid
+   * @return the offset of the count slot
+   */
+  public int getOffset(int c) {
+    return cenOffsets[c];
+  }
+
+  /**
+   * For each point, find the nearest packed
+   * centroid closer than minDistances[p]. On
+   * return minDistances[p] holds the new minimum
+   * and nearest[p] the index of the centroid, or
+   * -1 if no centroid is closer than the given
+   * minimum.
+   * 
+   * @param points
+   *          the point array
+   * @param numPoints
+   *          the number of points
+   * @param nearest
+   *          the nearest centroid of each point
+   * @param minDistances
+   *          the squared minimum distance of each
+   *          point, in and out
+   * @param pointNorms
+   *          the scratch of the calling thread,
+   *          from newScratch()
+   */
+  public void findNearest(double[] points,
+    int numPoints, int[] nearest,
+    double[] minDistances, double[] pointNorms) {
+    for (int p = 0; p < numPoints; p++) {
+      nearest[p] = -1;
+    }
+    for (int pStart = 0; pStart < numPoints; pStart +=
+      pointBlockSize) {
+      int pEnd = Math.min(numPoints,
+        pStart + pointBlockSize);
+      for (int p = pStart; p < pEnd; p++) {
+        pointNorms[p - pStart] =
+          norm(points, p * cenVecSize + 1);
+      }
+      for (int cStart = 0; cStart < numCentroids; cStart +=
+        cenBlockSize) {
+        int cEnd = Math.min(numCentroids,
+          cStart + cenBlockSize);
+        for (int p = pStart; p < pEnd; p++) {
+          findNearestInBlock(points, p,
+            pointNorms[p - pStart], cStart, cEnd,
+            nearest, minDistances);
+        }
+      }
+    }
+  }
+
+  /**
+   * Compare one point with a block of centroids
+   */
+  private void findNearestInBlock(
+    double[] points, int p, double pointNorm,
+    int cStart, int cEnd, int[] nearest,
+    double[] minDistances) {
+    final int d = dim;
+    final double[] vecs = cenVecs;
+    final int x = p * cenVecSize + 1;
+    double minDistance = minDistances[p];
+    int minC = nearest[p];
+    int c = cStart;
+    for (; c + 4 <= cEnd; c += 4) {
+      int c0 = c * d;
+      int c1 = c0 + d;
+      int c2 = c1 + d;
+      int c3 = c2 + d;
+      double dot0 = 0.0;
+      double dot1 = 0.0;
+      double dot2 = 0.0;
+      double dot3 = 0.0;
+      for (int l = 0; l < d; l++) {
+        double v = points[x + l];
+        dot0 += v * vecs[c0 + l];
+        dot1 += v * vecs[c1 + l];
+        dot2 += v * vecs[c2 + l];
+        dot3 += v * vecs[c3 + l];
+      }
+      double dist0 =
+        pointNorm + cenNorms[c] - 2.0 * dot0;
+      double dist1 =
+        pointNorm + cenNorms[c + 1] - 2.0 * dot1;
+      double dist2 =
+        pointNorm + cenNorms[c + 2] - 2.0 * dot2;
+      double dist3 =
+        pointNorm + cenNorms[c + 3] - 2.0 * dot3;
+      if (dist0 < minDistance) {
+        minDistance = dist0;
+        minC = c;
+      }
+      if (dist1 < minDistance) {
+        minDistance = dist1;
+        minC = c + 1;
+      }
+      if (dist2 < minDistance) {
+        minDistance = dist2;
+        minC = c + 2;
+      }
+      if (dist3 < minDistance) {
+        minDistance = dist3;
+        minC = c + 3;
+      }
+    }
+    for (; c < cEnd; c++) {
+      int c0 = c * d;
+      double dot = 0.0;
+      for (int l = 0; l < d; l++) {
+        dot += points[x + l] * vecs[c0 + l];
+      }
+      double dist =
+        pointNorm + cenNorms[c] - 2.0 * dot;
+      if (dist < minDistance) {
+        minDistance = dist;
+        minC = c;
+      }
+    }
+    // The expansion can go slightly below zero
+    // through rounding
+    minDistances[p] =
+      minDistance < 0.0 ? 0.0 : minDistance;
+    nearest[p] = minC;
+  }
+
+  /**
+   * The squared norm of a vector
+   */
+  private double norm(double[] array,
+    int start) {
+    double norm0 = 0.0;
+    double norm1 = 0.0;
+    int l = 0;
+    for (; l + 2 <= dim; l += 2) {
+      double v0 = array[start + l];
+      double v1 = array[start + l + 1];
+      norm0 += v0 * v0;
+      norm1 += v1 * v1;
+    }
+    if (l < dim) {
+      double v = array[start + l];
+      norm0 += v * v;
+    }
+    return norm0 + norm1;
+  }
+
+  /**
+   * Add the local arrays of all tasks to the
+   * global array and reset them to zero. The
+   * array is processed in cache-sized chunks so
+   * the global chunk stays in L1 while the local
+   * arrays are streamed.
+   * 
+   * @param global
+   *          the global array
+   * @param locals
+   *          the local arrays
+   * @param size
+   *          the number of elements
+   */
+  public static void sumAndReset(double[] global,
+    Collection<double[]> locals, int size) {
+    final int chunk = POINT_BLOCK_BYTES / 8;
+    for (int start = 0; start < size; start +=
+      chunk) {
+      int end = Math.min(size, start + chunk);
+      for (int i = start; i < end; i++) {
+        global[i] = 0.0;
+      }
+      for (double[] local : locals) {
+        for (int i = start; i < end; i++) {
+          global[i] += local[i];
+          local[i] = 0.0;
+        }
+      }
+    }
+  }
+}
@@ -0,0 +1,242 @@
+/*
+ * Copyright 2013-2017 Indiana University
+ * 
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+package edu.iu.kmeans.regroupallgather;
+
+import edu.iu.harp.example.DoubleArrPlus;
+import edu.iu.harp.partition.Partition;
+import edu.iu.harp.partition.Table;
+import edu.iu.harp.resource.DoubleArray;
+import edu.iu.harp.schdynamic.DynamicScheduler;
+import edu.iu.harp.schdynamic.Task;
+
+import java.util.LinkedList;
+import java.util.List;
+import java.util.Random;
+
+/*******************************************************
+ * A benchmark of the KMeans assignment step,
+ * comparing the scalar point-by-point loop with
+ * the blocked DistanceKernel used by CenCalcTask.
+ * It sweeps the number of centroids, the vector
+ * dimension and the number of threads, and
+ * reports the best time of the measured
+ * iterations after warmup.
+ * 
+ * Usage: DistanceKernelBenchmark kList dList
+ * threadList numPoints [numIterations], where
+ * the lists are comma separated, e.g.
+ * DistanceKernelBenchmark 100,1000 10,100,1000
+ * 1,4,16 100000
+ ******************************************************/
+public class DistanceKernelBenchmark {
+
+  private static final int NUM_CEN_PARTITIONS = 4;
+  private static final int POINTS_PER_ARRAY =
+    1000;
+  private static final int NUM_WARMUPS = 2;
+
+  /**
+   * The scalar loop CenCalcTask used before the
+   * blocked kernel
+   */
+  private static class ScalarCalcTask
+    implements Task<double[], Object> {
+    private final double[][] centroids;
+    private final double[][] local;
+    private final int cenVecSize;
+
+    private ScalarCalcTask(
+      Table<DoubleArray> cenTable,
+      int cenVecSize) {
+      centroids =
+        new double[cenTable.getNumPartitions()][];
+      local = new double[centroids.length][];
+      for (Partition<DoubleArray> partition : cenTable
+        .getPartitions()) {
+        centroids[partition.id()] =
+          partition.get().get();
+        local[partition.id()] =
+          new double[partition.get().size()];
+      }
+      this.cenVecSize = cenVecSize;
+    }
+
+    @Override
+    public Object run(double[] points)
+      throws Exception {
+      for (int i = 0; i < points.length;) {
+        i++;
+        double minDistance = Double.MAX_VALUE;
+        int minCenParID = 0;
+        int minOffset = 0;
+        for (int j = 0; j < centroids.length; j++) {
+          for (int k = 0; k < local[j].length;) {
+            int pStart = i;
+            k++;
+            double distance = 0.0;
+            for (int l = 1; l < cenVecSize; l++) {
+              double diff = (points[pStart++]
+                - centroids[j][k++]);
+              distance += diff * diff;
+            }
+            if (distance < minDistance) {
+              minDistance = distance;
+              minCenParID = j;
+              minOffset = k - cenVecSize;
+            }
+          }
+        }
+        local[minCenParID][minOffset++]++;
+        for (int j = 1; j < cenVecSize; j++) {
+          local[minCenParID][minOffset++] +=
+            points[i++];
+        }
+      }
+      return null;
+    }
+  }
+
+  public static void main(String args[])
+    throws Exception {
+    int[] kList = parseList(args[0]);
+    int[] dList = parseList(args[1]);
+    int[] threadList = parseList(args[2]);
+    int numPoints = Integer.parseInt(args[3]);
+    int numIterations = args.length > 4
+      ? Integer.parseInt(args[4]) : 3;
+    System.out.println(String.format(
+      "%8s %6s %8s %12s %12s %8s %10s", "k", "d",
+      "threads", "scalar(ms)", "blocked(ms)",
+      "speedup", "GFLOP/s"));
+    Random random = new Random(0L);
+    for (int k : kList) {
+      for (int d : dList) {
+        int cenVecSize = d + 1;
+        List<double[]> pointArrays =
+          generatePoints(random, numPoints,
+            cenVecSize);
+        Table<DoubleArray> cenTable =
+          generateCentroids(random, k, cenVecSize);
+        for (int numThreads : threadList) {
+          List<ScalarCalcTask> scalarTasks =
+            new LinkedList<>();
+          List<CenCalcTask> blockedTasks =
+            new LinkedList<>();
+          DistanceKernel kernel =
+            new DistanceKernel(cenVecSize);
+          kernel.pack(cenTable.getPartitions());
+          for (int i = 0; i < numThreads; i++) {
+            scalarTasks.add(new ScalarCalcTask(
+              cenTable, cenVecSize));
+            blockedTasks.add(
+              new CenCalcTask(cenTable, cenVecSize,
+                kernel));
+          }
+          long scalarTime = run(
+            new DynamicScheduler<>(scalarTasks),
+            pointArrays, numIterations);
+          long blockedTime = run(
+            new DynamicScheduler<>(blockedTasks),
+            pointArrays, numIterations);
+          // 3 flops per element in the distance
+          double flops =
+            3.0 * numPoints * (double) k * d;
+          System.out.println(String.format(
+            "%8d %6d %8d %12.2f %12.2f %8.2f %10.2f",
+            k, d, numThreads, scalarTime / 1e6,
+            blockedTime / 1e6,
+            (double) scalarTime / blockedTime,
+            flops / blockedTime));
+        }
+        cenTable.release();
+      }
+    }
+  }
+
+  /**
+   * Run warmup and measured iterations, return
+   * the best time in nanoseconds
+   */
+  private static <T extends Task<double[], Object>> long
+    run(DynamicScheduler<double[], Object, T> compute,
+      List<double[]> pointArrays,
+      int numIterations) {
+    compute.start();
+    long bestTime = Long.MAX_VALUE;
+    for (int i = 0; i < NUM_WARMUPS
+      + numIterations; i++) {
+      long startTime = System.nanoTime();
+      compute.submitAll(pointArrays);
+      while (compute.hasOutput()) {
+        compute.waitForOutput();
+      }
+      long time = System.nanoTime() - startTime;
+      if (i >= NUM_WARMUPS && time < bestTime) {
+        bestTime = time;
+      }
+    }
+    compute.stop();
+    return bestTime;
+  }
+
+  private static List<double[]> generatePoints(
+    Random random, int numPoints, int cenVecSize) {
+    List<double[]> pointArrays =
+      new LinkedList<>();
+    for (int start = 0; start < numPoints; start +=
+      POINTS_PER_ARRAY) {
+      int size = Math.min(POINTS_PER_ARRAY,
+        numPoints - start);
+      double[] points = new double[size * cenVecSize];
+      for (int i = 0; i < points.length; i++) {
+        points[i] = random.nextDouble() * 1000;
+      }
+      pointArrays.add(points);
+    }
+    return pointArrays;
+  }
+
+  private static Table<DoubleArray>
+    generateCentroids(Random random,
+      int numCentroids, int cenVecSize) {
+    Table<DoubleArray> cenTable =
+      new Table<>(0, new DoubleArrPlus());
+    int numCenPars =
+      Math.min(NUM_CEN_PARTITIONS, numCentroids);
+    for (int i = 0; i < numCenPars; i++) {
+      int numCens = numCentroids / numCenPars
+        + (i < numCentroids % numCenPars ? 1 : 0);
+      DoubleArray array = DoubleArray
+        .create(numCens * cenVecSize, false);
+      double[] doubles = array.get();
+      for (int j = 0; j < array.size(); j++) {
+        doubles[j] = random.nextDouble() * 1000;
+      }
+      cenTable.addPartition(
+        new Partition<>(i, array));
+    }
+    return cenTable;
+  }
+
+  private static int[] parseList(String list) {
+    String[] tokens = list.split(",");
+    int[] values = new int[tokens.length];
+    for (int i = 0; i < tokens.length; i++) {
+      values[i] = Integer.parseInt(tokens[i]);
+    }
+    return values;
+  }
+}
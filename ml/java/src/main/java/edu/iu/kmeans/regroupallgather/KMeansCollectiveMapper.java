@@ -124,12 +124,16 @@ public class KMeansCollectiveMapper extends
     List<double[]> pointArrays =
       KMUtil.loadPoints(fileNames, pointsPerFile,
         cenVecSize, conf, numThreads);
-    // Initialize tasks
+    // Initialize tasks, they share the packed
+    // centroids
+    DistanceKernel kernel =
+      new DistanceKernel(cenVecSize);
+    kernel.pack(cenTable.getPartitions());
     List<CenCalcTask> cenCalcTasks =
       new LinkedList<>();
     for (int i = 0; i < numThreads; i++) {
-      cenCalcTasks.add(
-        new CenCalcTask(cenTable, cenVecSize));
+      cenCalcTasks.add(new CenCalcTask(cenTable,
+        cenVecSize, kernel));
     }
     DynamicScheduler<double[], Object, CenCalcTask> calcCompute =
       new DynamicScheduler<>(cenCalcTasks);
@@ -183,10 +187,7 @@ public class KMeansCollectiveMapper extends
       }
       allgather("main", "allgather-" + i,
         cenTable);
-      for (CenCalcTask task : calcCompute
-        .getTasks()) {
-        task.update(cenTable);
-      }
+      kernel.pack(cenTable.getPartitions());
       long t4 = System.currentTimeMillis();
       LOG.info("Compute: " + (t2 - t1)
         + ", Merge: " + (t3 - t2)
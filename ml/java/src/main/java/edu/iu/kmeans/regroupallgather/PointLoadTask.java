@@ -16,6 +16,8 @@
 
 package edu.iu.kmeans.regroupallgather;
 
+import edu.iu.fileformat.ColumnarFile;
+import edu.iu.fileformat.FileBlock;
 import edu.iu.harp.schdynamic.Task;
 import org.apache.commons.logging.Log;
 import org.apache.commons.logging.LogFactory;
@@ -25,6 +27,8 @@ import org.apache.hadoop.fs.FileSystem;
 import org.apache.hadoop.fs.Path;
 
 import java.io.IOException;
+import java.nio.ByteBuffer;
+import java.util.List;
 
 public class PointLoadTask
   implements Task<String, double[]> {
@@ -76,6 +80,10 @@ public class PointLoadTask
   public static double[] loadPoints(String file,
     int pointsPerFile, int cenVecSize,
     Configuration conf) throws Exception {
+    if (ColumnarFile.isColumnar(file, conf)) {
+      return loadColumnarPoints(file, cenVecSize,
+        conf);
+    }
     double[] points =
       new double[pointsPerFile * cenVecSize];
     Path pointFilePath = new Path(file);
@@ -94,4 +102,48 @@ public class PointLoadTask
     }
     return points;
   }
+
+  /**
+   * Load data points from a columnar file. The
+   * blocks are copied into the point array in
+   * bulk, leaving the first slot of each point
+   * for the minimum distance.
+   * 
+   * @param file
+   * @param cenVecSize
+   * @param conf
+   * @return
+   * @throws Exception
+   */
+  public static double[] loadColumnarPoints(
+    String file, int cenVecSize,
+    Configuration conf) throws Exception {
+    List<FileBlock> blocks =
+      ColumnarFile.getBlocks(file, conf);
+    int numPoints = 0;
+    for (FileBlock block : blocks) {
+      if (block.getKind() != ColumnarFile.POINTS
+        || block.getDim() != cenVecSize - 1) {
+        throw new Exception("Not a points file of "
+          + (cenVecSize - 1) + " dimensions "
+          + block);
+      }
+      numPoints += block.getNumRecords();
+    }
+    double[] points =
+      new double[numPoints * cenVecSize];
+    int pos = 0;
+    for (FileBlock block : blocks) {
+      ByteBuffer buffer =
+        ColumnarFile.readBlock(block, conf);
+      int start = pos;
+      pos = ColumnarFile.readPoints(buffer,
+        block.getNumRecords(), block.getDim(),
+        points, pos, 1);
+      for (int i = start; i < pos; i += cenVecSize) {
+        points[i] = Double.MAX_VALUE;
+      }
+    }
+    return points;
+  }
 }
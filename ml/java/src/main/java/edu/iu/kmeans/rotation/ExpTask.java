@@ -16,16 +16,11 @@
 
 package edu.iu.kmeans.rotation;
 
-import edu.iu.harp.partition.Partition;
-import edu.iu.harp.partition.Table;
-import edu.iu.harp.resource.DoubleArray;
 import edu.iu.harp.schdynamic.Task;
+import edu.iu.kmeans.regroupallgather.DistanceKernel;
 import org.apache.commons.logging.Log;
 import org.apache.commons.logging.LogFactory;
 
-import java.util.ArrayList;
-import java.util.List;
-
 class Points {
 
   public double[] pointArray;
@@ -38,20 +33,24 @@ public class ExpTask
   protected static final Log LOG =
     LogFactory.getLog(ExpTask.class);
 
-  private Table<DoubleArray> cenTable;
-  private List<Partition<DoubleArray>> centroids;
   private final int cenVecSize;
+  private final DistanceKernel kernel;
+  private final double[] scratch;
+  private int[] nearest;
+  private double[] minDistances;
 
-  public ExpTask(Table<DoubleArray> cenTable,
-    int cenVecSize) {
-    this.cenTable = cenTable;
-    this.centroids = new ArrayList<>();
+  /**
+   * The kernel is shared by all the tasks and
+   * packed by the caller before each rotation
+   * step
+   */
+  public ExpTask(int cenVecSize,
+    DistanceKernel kernel) {
     this.cenVecSize = cenVecSize;
-  }
-
-  public void update() {
-    centroids.clear();
-    centroids.addAll(cenTable.getPartitions());
+    this.kernel = kernel;
+    scratch = kernel.newScratch();
+    nearest = new int[0];
+    minDistances = new double[0];
   }
 
   @Override
@@ -59,33 +58,26 @@ public class ExpTask
     throws Exception {
     double[] pointArray = points.pointArray;
     int[][] cenIDs = points.cenIDs;
-    int pointIndex = 0;
-    for (int i = 0; i < pointArray.length; i +=
-      cenVecSize) {
-      int[] cenID = cenIDs[pointIndex];
-      double minDistance = pointArray[i];
-      for (Partition<DoubleArray> partition : centroids) {
-        int partitionID = partition.id();
-        double[] cenArray = partition.get().get();
-        int cenArrSize = partition.get().size();
-        for (int k = 0; k < cenArrSize;) {
-          int pStart = i + 1;
-          k++;
-          double distance = 0.0;
-          for (int l = 1; l < cenVecSize; l++) {
-            double diff = (pointArray[pStart++]
-              - cenArray[k++]);
-            distance += diff * diff;
-          }
-          if (distance < minDistance) {
-            minDistance = distance;
-            cenID[0] = partitionID;
-            cenID[1] = k - cenVecSize;
-          }
-        }
+    int numPoints = pointArray.length / cenVecSize;
+    if (nearest.length < numPoints) {
+      nearest = new int[numPoints];
+      minDistances = new double[numPoints];
+    }
+    // Start from the minimum distance found in
+    // the previous rotation steps
+    for (int p = 0; p < numPoints; p++) {
+      minDistances[p] = pointArray[p * cenVecSize];
+    }
+    kernel.findNearest(pointArray, numPoints,
+      nearest, minDistances, scratch);
+    for (int p = 0; p < numPoints; p++) {
+      int c = nearest[p];
+      if (c >= 0) {
+        cenIDs[p][0] = kernel.getPartitionID(c);
+        cenIDs[p][1] = kernel.getOffset(c);
+        pointArray[p * cenVecSize] =
+          minDistances[p];
       }
-      pointArray[i] = minDistance;
-      pointIndex++;
     }
     return null;
   }
@@ -22,6 +22,7 @@ import edu.iu.harp.partition.Table;
 import edu.iu.harp.resource.DoubleArray;
 import edu.iu.harp.schdynamic.DynamicScheduler;
 import edu.iu.kmeans.regroupallgather.Constants;
+import edu.iu.kmeans.regroupallgather.DistanceKernel;
 import edu.iu.kmeans.regroupallgather.KMUtil;
 import org.apache.hadoop.conf.Configuration;
 import org.apache.hadoop.mapred.CollectiveMapper;
@@ -128,10 +129,12 @@ public class KMeansCollectiveMapper extends
     generateCenTable(cenTable, numCentroids,
       numCenPars, cenVecSize);
     // Initialize tasks
+    DistanceKernel kernel =
+      new DistanceKernel(cenVecSize);
     List<ExpTask> expTasks = new LinkedList<>();
     for (int i = 0; i < numThreads; i++) {
       expTasks
-        .add(new ExpTask(cenTable, cenVecSize));
+        .add(new ExpTask(cenVecSize, kernel));
     }
     DynamicScheduler<Points, Object, ExpTask> expCompute =
       new DynamicScheduler<>(expTasks);
@@ -153,10 +156,9 @@ public class KMeansCollectiveMapper extends
       for (int j = 0; j < this
         .getNumWorkers(); j++) {
         // LOG.info("Expectation Round: " + j);
-        for (ExpTask task : expCompute
-          .getTasks()) {
-          task.update();
-        }
+        // Pack the centroids held in this step
+        // once for all the tasks
+        kernel.pack(cenTable.getPartitions());
         expCompute.submitAll(pointsList);
         while (expCompute.hasOutput()) {
           expCompute.waitForOutput();
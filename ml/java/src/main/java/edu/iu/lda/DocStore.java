@@ -16,6 +16,8 @@
 
 package edu.iu.lda;
 
+import edu.iu.fileformat.ColumnarFile;
+import edu.iu.fileformat.FileBlock;
 import edu.iu.harp.schdynamic.DynamicScheduler;
 import edu.iu.harp.schdynamic.Task;
 import it.unimi.dsi.fastutil.ints.Int2ObjectOpenHashMap;
@@ -28,6 +30,7 @@ import org.apache.hadoop.fs.Path;
 
 import java.io.BufferedReader;
 import java.io.InputStreamReader;
+import java.nio.ByteBuffer;
 import java.util.LinkedList;
 import java.util.List;
 import java.util.concurrent.atomic.AtomicInteger;
@@ -60,7 +63,9 @@ public class DocStore {
   }
 
   /**
-   * Load input based on the number of threads
+   * Load input based on the number of threads.
+   * Columnar files are split into blocks so that
+   * a large file is loaded by several threads.
    * 
    * @return
    */
@@ -68,16 +73,27 @@ public class DocStore {
     Int2ObjectOpenHashMap<DocWord> vDocMap,
     Int2ObjectOpenHashMap<String> docIDMap) {
     long start = System.currentTimeMillis();
+    List<FileBlock> blocks = null;
+    try {
+      blocks =
+        ColumnarFile.getBlocks(inputFiles, conf);
+    } catch (Exception e) {
+      LOG.error("Fail to read the file blocks", e);
+      blocks = new LinkedList<>();
+      for (String inputFile : inputFiles) {
+        blocks.add(new FileBlock(inputFile));
+      }
+    }
     LinkedList<VLoadTask> vLoadTasks =
       new LinkedList<>();
     for (int i = 0; i < numThreads; i++) {
       vLoadTasks
         .add(new VLoadTask(conf, idGenerator));
     }
-    DynamicScheduler<String, Object, VLoadTask> vLoadCompute =
+    DynamicScheduler<FileBlock, Object, VLoadTask> vLoadCompute =
       new DynamicScheduler<>(vLoadTasks);
     vLoadCompute.start();
-    vLoadCompute.submitAll(inputFiles);
+    vLoadCompute.submitAll(blocks);
     vLoadCompute.stop();
     int totalNumDocs = 0;
     for (VLoadTask task : vLoadCompute
@@ -99,7 +115,8 @@ public class DocStore {
   }
 }
 
-class VLoadTask implements Task<String, Object> {
+class VLoadTask
+  implements Task<FileBlock, Object> {
   protected static final Log LOG =
     LogFactory.getLog(VLoadTask.class);
 
@@ -108,6 +125,11 @@ class VLoadTask implements Task<String, Object> {
   private final Int2ObjectOpenHashMap<String> docIDMap;
   private int numDocs;
   private final AtomicInteger idGenerator;
+  // Column buffers reused across columnar blocks
+  private int[] numWords;
+  private int[] wordIDs;
+  private int[] nameLengths;
+  private byte[] nameBytes;
 
   public VLoadTask(Configuration conf,
     AtomicInteger idGenerator) {
@@ -116,11 +138,20 @@ class VLoadTask implements Task<String, Object> {
     docIDMap = new Int2ObjectOpenHashMap<>();
     numDocs = 0;
     this.idGenerator = idGenerator;
+    numWords = null;
+    wordIDs = null;
+    nameLengths = null;
+    nameBytes = null;
   }
 
   @Override
-  public Object run(String inputFile)
+  public Object run(FileBlock block)
     throws Exception {
+    if (block.isColumnar()) {
+      loadBlock(block);
+      return null;
+    }
+    String inputFile = block.getFile();
     Path inputFilePath = new Path(inputFile);
     // Open the file
     boolean isFailed = false;
@@ -174,6 +205,48 @@ class VLoadTask implements Task<String, Object> {
     return null;
   }
 
+  /**
+   * Load a block of a columnar DOCS file
+   * 
+   * @param block
+   *          the block
+   * @throws Exception
+   */
+  private void loadBlock(FileBlock block)
+    throws Exception {
+    if (block.getKind() != ColumnarFile.DOCS) {
+      throw new Exception(
+        "Not a docs file " + block);
+    }
+    ByteBuffer buffer =
+      ColumnarFile.readBlock(block, conf);
+    int numRecords = block.getNumRecords();
+    numWords =
+      ColumnarFile.ensure(numWords, numRecords);
+    wordIDs = ColumnarFile.ensure(wordIDs,
+      block.getNumValues());
+    nameLengths =
+      ColumnarFile.ensure(nameLengths, numRecords);
+    int namePos = ColumnarFile.readDocs(buffer,
+      numRecords, block.getNumValues(), numWords,
+      wordIDs, nameLengths);
+    int wordPos = 0;
+    for (int i = 0; i < numRecords; i++) {
+      int doc = idGenerator.incrementAndGet();
+      nameBytes =
+        ColumnarFile.ensure(nameBytes, nameLengths[i]);
+      docIDMap.put(doc, ColumnarFile.readDocName(
+        buffer, namePos, nameLengths[i],
+        nameBytes));
+      namePos += nameLengths[i];
+      for (int j = 0; j < numWords[i]; j++) {
+        LDAUtil.addToData(vDocMap, doc,
+          wordIDs[wordPos++], 1);
+      }
+      numDocs++;
+    }
+  }
+
   public Int2ObjectOpenHashMap<DocWord>
     getDocMap() {
     return vDocMap;
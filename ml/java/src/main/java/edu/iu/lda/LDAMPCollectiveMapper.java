@@ -273,6 +273,9 @@ public class LDAMPCollectiveMapper extends
     // -----------------------------------------
     // For iteration
     for (int i = 1; i <= numIterations; i++) {
+      // Only count the rotations of training
+      rotator.resetCommTime();
+      rotator.resetExposedTime();
       long iteStart = System.currentTimeMillis();
       for (int j = 0; j < numWorkers; j++) {
         for (int k = 0; k < numModelSlices; k++) {
@@ -330,7 +333,10 @@ public class LDAMPCollectiveMapper extends
         + computeTime + ", misc: " + waitTime
         + "\\" + (itePause2 - itePause1) + "\\"
         + (itePause3 - itePause2) + "\\"
-        + (iteEnd - itePause3) + ", numTokens: "
+        + (iteEnd - itePause3)
+        + ", rotation exposed/total: "
+        + rotator.resetExposedTime() + "/"
+        + rotator.resetCommTime() + ", numTokens: "
         + numVTrained + ", percentage(%): "
         + percentage);
       computeTime = 0L;
@@ -261,6 +261,9 @@ public class SGDCollectiveMapper extends
     // -----------------------------------------
     // For iteration
     for (int i = 1; i <= numIterations; i++) {
+      // Only count the rotations of training
+      rotator.resetCommTime();
+      rotator.resetExposedTime();
       long iteStart = System.currentTimeMillis();
       for (int j = 0; j < numWorkers; j++) {
         for (int k = 0; k < numModelSlices; k++) {
@@ -295,6 +298,9 @@ public class SGDCollectiveMapper extends
         + (iteEnd - iteStart) + ", num V: "
         + numVTrained + ", compute time: "
         + computeTime + ", misc: " + waitTime
+        + ", rotation exposed/total: "
+        + rotator.resetExposedTime() + "/"
+        + rotator.resetCommTime()
         + ", percentage(%): " + percentage);
       computeTime = 0L;
       waitTime = 0L;
@@ -16,6 +16,8 @@
 
 package edu.iu.sgd;
 
+import edu.iu.fileformat.ColumnarFile;
+import edu.iu.fileformat.FileBlock;
 import edu.iu.harp.schdynamic.DynamicScheduler;
 import edu.iu.harp.schdynamic.Task;
 import it.unimi.dsi.fastutil.ints.Int2ObjectMap;
@@ -30,10 +32,12 @@ import org.apache.hadoop.fs.Path;
 
 import java.io.BufferedReader;
 import java.io.InputStreamReader;
+import java.nio.ByteBuffer;
 import java.util.LinkedList;
 import java.util.List;
 
-class VLoadTask implements Task<String, Object> {
+class VLoadTask
+  implements Task<FileBlock, Object> {
   protected static final Log LOG =
     LogFactory.getLog(VLoadTask.class);
 
@@ -43,6 +47,10 @@ class VLoadTask implements Task<String, Object> {
   private final Int2ObjectOpenHashMap<VRowCol> vHMap;
   private final Int2ObjectOpenHashMap<VRowCol> vWMap;
   private int numPoints;
+  // Column buffers reused across columnar blocks
+  private int[] rowIDs;
+  private int[] colIDs;
+  private double[] values;
 
   public VLoadTask(Configuration conf,
     boolean useVHMap, boolean useVWMap) {
@@ -52,11 +60,19 @@ class VLoadTask implements Task<String, Object> {
     vHMap = new Int2ObjectOpenHashMap<VRowCol>();
     vWMap = new Int2ObjectOpenHashMap<VRowCol>();
     numPoints = 0;
+    rowIDs = null;
+    colIDs = null;
+    values = null;
   }
 
   @Override
-  public Object run(String inputFile)
+  public Object run(FileBlock block)
     throws Exception {
+    if (block.isColumnar()) {
+      loadBlock(block);
+      return null;
+    }
+    String inputFile = block.getFile();
     Path inputFilePath = new Path(inputFile);
     // Open the file
     boolean isFailed = false;
@@ -118,6 +134,40 @@ class VLoadTask implements Task<String, Object> {
     return null;
   }
 
+  /**
+   * Load a block of a columnar RATINGS file
+   * 
+   * @param block
+   *          the block
+   * @throws Exception
+   */
+  private void loadBlock(FileBlock block)
+    throws Exception {
+    if (block.getKind() != ColumnarFile.RATINGS) {
+      throw new Exception(
+        "Not a ratings file " + block);
+    }
+    ByteBuffer buffer =
+      ColumnarFile.readBlock(block, conf);
+    int numRecords = block.getNumRecords();
+    rowIDs = ColumnarFile.ensure(rowIDs, numRecords);
+    colIDs = ColumnarFile.ensure(colIDs, numRecords);
+    values = ColumnarFile.ensure(values, numRecords);
+    ColumnarFile.readRatings(buffer, numRecords,
+      rowIDs, colIDs, values);
+    for (int i = 0; i < numRecords; i++) {
+      if (useVHMap) {
+        VStore.add(vHMap, colIDs[i], rowIDs[i],
+          values[i]);
+      }
+      if (useVWMap) {
+        VStore.add(vWMap, rowIDs[i], colIDs[i],
+          values[i]);
+      }
+    }
+    numPoints += numRecords;
+  }
+
   public Int2ObjectOpenHashMap<VRowCol>
     getVHMap() {
     return vHMap;
@@ -155,23 +205,35 @@ public class VStore {
   }
 
   /**
-   * Load input based on the number of threads
+   * Load input based on the number of threads.
+   * Columnar files are split into blocks so that
+   * a large file is loaded by several threads.
    * 
    * @return
    */
   public void load(boolean useVHMap,
     boolean useVWMap) {
     long start = System.currentTimeMillis();
+    List<FileBlock> blocks = null;
+    try {
+      blocks = ColumnarFile.getBlocks(inputs, conf);
+    } catch (Exception e) {
+      LOG.error("Fail to read the file blocks", e);
+      blocks = new LinkedList<>();
+      for (String input : inputs) {
+        blocks.add(new FileBlock(input));
+      }
+    }
     List<VLoadTask> vLoadTasks =
       new LinkedList<>();
     for (int i = 0; i < numThreads; i++) {
       vLoadTasks.add(
         new VLoadTask(conf, useVHMap, useVWMap));
     }
-    DynamicScheduler<String, Object, VLoadTask> vLoadCompute =
+    DynamicScheduler<FileBlock, Object, VLoadTask> vLoadCompute =
       new DynamicScheduler<>(vLoadTasks);
     vLoadCompute.start();
-    vLoadCompute.submitAll(inputs);
+    vLoadCompute.submitAll(blocks);
     vLoadCompute.stop();
     while (vLoadCompute.hasOutput()) {
       vLoadCompute.waitForOutput();